@@ -3,7 +3,8 @@
 #ifdef WITH_SYCL_KERNELS
 
 #include "ColorConversionKernel.h"
-#include <algorithm> // For std::clamp
+#include <algorithm> // For std::clamp, std::min and std::max
+#include <vector>
 
 namespace facebook::torchcodec {
 
@@ -99,6 +100,31 @@ sycl::uchar3 yuv2rgb(uint8_t y, uint8_t u, uint8_t v, bool fullrange, const floa
   return dst;
 }
 
+// Reads pixel (x, y) from Intel Y-tiled NV12 planes and converts it to RGB.
+// Luma value of the pixel is returned via luma.
+sycl::uchar3 nv12_pixel_to_rgb(
+    const uint8_t* y_plane,
+    const uint8_t* uv_plane,
+    int x,
+    int y,
+    int stride,
+    bool fullrange,
+    const float3x3 &rgb_matrix,
+    uint8_t &luma) {
+  int ux = sycl::floor(x/2.0);
+  int uy = sycl::floor(y/2.0);
+
+  size_t tiled_idx_y = get_tile_offset(x, y, stride);
+  size_t tiled_idx_u = get_tile_offset(2*ux, uy, stride);
+  size_t tiled_idx_v = get_tile_offset(2*ux+1, uy, stride);
+
+  luma = y_plane[tiled_idx_y];
+  uint8_t u = uv_plane[tiled_idx_u];
+  uint8_t v = uv_plane[tiled_idx_v];
+
+  return yuv2rgb(luma, u, v, fullrange, rgb_matrix);
+}
+
 struct NV12toRGBKernel {
   const uint8_t* y_plane;
   const uint8_t* uv_plane;
@@ -136,18 +162,9 @@ struct NV12toRGBKernel {
       return;
     }
 
-    int ux = sycl::floor(yx/2.0);
-    int uy = sycl::floor(yy/2.0);
-
-    size_t tiled_idx_y = get_tile_offset(yx, yy, stride);
-    size_t tiled_idx_u = get_tile_offset(2*ux, uy, stride);
-    size_t tiled_idx_v = get_tile_offset(2*ux+1, uy, stride);
-
-    uint8_t y = y_plane[tiled_idx_y];
-    uint8_t u = uv_plane[tiled_idx_u];
-    uint8_t v = uv_plane[tiled_idx_v];
-
-    sycl::uchar3 rgb = yuv2rgb(y, u, v, fullrange, rgb_matrix);
+    uint8_t luma;
+    sycl::uchar3 rgb = nv12_pixel_to_rgb(
+        y_plane, uv_plane, yx, yy, stride, fullrange, rgb_matrix, luma);
 
     int rgb_idx = 3 * (yy * width + yx);
 
@@ -157,7 +174,285 @@ struct NV12toRGBKernel {
   }
 };
 
-void convertNV12ToRGB(
+// Thumbnail cell covers pixels [begin, end) along dimension of given length.
+// Cells of frames smaller than the thumbnail are single pixels shared by
+// several cells.
+int thumbnail_cell_begin(int cell, int length, int size) {
+  return cell * length / size;
+}
+
+int thumbnail_cell_end(int cell, int length, int size) {
+  return std::max(
+      (cell + 1) * length / size, thumbnail_cell_begin(cell, length, size) + 1);
+}
+
+// First thumbnail cell which covers pixel p.
+int first_thumbnail_cell(int p, int length, int size) {
+  int cell = p * size / length;
+  while (thumbnail_cell_end(cell, length, size) <= p) {
+    ++cell;
+  }
+  return cell;
+}
+
+// Upper bound of the number of thumbnail cells covering span of work-group
+// size pixels along dimension of given length.
+int thumbnail_cells_per_group(int length, int size, int group_size) {
+  if (length >= size) {
+    return std::min(size, (group_size - 1) / (length / size) + 2);
+  }
+  return std::min(size, group_size * ((size + length - 1) / length) + 1);
+}
+
+// Same conversion as NV12toRGBKernel which additionally collects per-frame
+// statistics in the same pass over the frame:
+// * luma histogram is accumulated in work-group local memory and flushed
+//   to global memory once per work-group
+// * per-channel sums and sums of squares are reduced over work-group and
+//   added to global memory once per work-group
+// * thumbnail cell sums are accumulated in work-group local memory for the
+//   window of cells work-group covers and flushed to global memory once per
+//   work-group
+struct NV12toRGBStatisticsKernel {
+  const uint8_t* y_plane;
+  const uint8_t* uv_plane;
+  uint8_t* rgb_output;
+  int width;
+  int height;
+  int stride;
+  bool fullrange;
+  float3x3 rgb_matrix;
+  FrameStatisticsBuffers stats;
+  sycl::local_accessor<uint32_t, 1> local_histogram;
+  // [window_height, window_width, 3] thumbnail cell sums.
+  sycl::local_accessor<uint32_t, 1> local_thumbnail;
+  int window_width;
+  int window_height;
+
+  NV12toRGBStatisticsKernel(
+      const uint8_t* y_plane,
+      const uint8_t* uv_plane,
+      uint8_t* rgb_output,
+      int width,
+      int height,
+      int stride,
+      bool fullrange,
+      const float3x3 &rgb_matrix,
+      const FrameStatisticsBuffers &stats,
+      sycl::local_accessor<uint32_t, 1> local_histogram,
+      sycl::local_accessor<uint32_t, 1> local_thumbnail,
+      int window_width,
+      int window_height):
+    y_plane(y_plane),
+    uv_plane(uv_plane),
+    rgb_output(rgb_output),
+    width(width),
+    height(height),
+    stride(stride),
+    fullrange(fullrange),
+    rgb_matrix(rgb_matrix),
+    stats(stats),
+    local_histogram(local_histogram),
+    local_thumbnail(local_thumbnail),
+    window_width(window_width),
+    window_height(window_height)
+  {}
+
+  void operator()(sycl::nd_item<2> item) const {
+    auto group = item.get_group();
+    size_t lid = item.get_local_linear_id();
+    size_t group_size = item.get_local_range().size();
+
+    size_t window_size = (size_t)window_width * window_height * 3;
+    for (size_t i = lid; i < (size_t)LUMA_HISTOGRAM_BINS; i += group_size) {
+      local_histogram[i] = 0;
+    }
+    for (size_t i = lid; i < window_size; i += group_size) {
+      local_thumbnail[i] = 0;
+    }
+    sycl::group_barrier(group);
+
+    int yx = item.get_global_id(1);
+    int yy = item.get_global_id(0);
+
+    // Window of thumbnail cells starts at the cell covering the first pixel
+    // of the work-group, which is always within the frame.
+    int size = stats.thumbnail_size;
+    int window_x = first_thumbnail_cell(
+        (int)(item.get_group(1) * item.get_local_range(1)), width, size);
+    int window_y = first_thumbnail_cell(
+        (int)(item.get_group(0) * item.get_local_range(0)), height, size);
+
+    // Out of frame items still have to take part in group operations.
+    int64_t rgb[3] = {0, 0, 0};
+    if (yx < width && yy < height) {
+      uint8_t luma;
+      sycl::uchar3 pixel = nv12_pixel_to_rgb(
+          y_plane, uv_plane, yx, yy, stride, fullrange, rgb_matrix, luma);
+
+      int rgb_idx = 3 * (yy * width + yx);
+      rgb_output[rgb_idx + 0] = pixel.x();
+      rgb_output[rgb_idx + 1] = pixel.y();
+      rgb_output[rgb_idx + 2] = pixel.z();
+
+      sycl::atomic_ref<
+          uint32_t,
+          sycl::memory_order::relaxed,
+          sycl::memory_scope::work_group,
+          sycl::access::address_space::local_space>
+          bin(local_histogram[luma]);
+      bin.fetch_add(1u);
+
+      rgb[0] = pixel.x();
+      rgb[1] = pixel.y();
+      rgb[2] = pixel.z();
+
+      // Pixels of frames smaller than the thumbnail belong to several
+      // cells, so loop over all cells covering this pixel.
+      for (int ty = first_thumbnail_cell(yy, height, size);
+           ty < size && thumbnail_cell_begin(ty, height, size) <= yy;
+           ++ty) {
+        for (int tx = first_thumbnail_cell(yx, width, size);
+             tx < size && thumbnail_cell_begin(tx, width, size) <= yx;
+             ++tx) {
+          int window_idx =
+              3 * ((ty - window_y) * window_width + (tx - window_x));
+          for (int c = 0; c < 3; ++c) {
+            sycl::atomic_ref<
+                uint32_t,
+                sycl::memory_order::relaxed,
+                sycl::memory_scope::work_group,
+                sycl::access::address_space::local_space>(
+                local_thumbnail[window_idx + c])
+                .fetch_add((uint32_t)rgb[c]);
+          }
+        }
+      }
+    }
+
+    for (int c = 0; c < 3; ++c) {
+      int64_t sum = sycl::reduce_over_group(group, rgb[c], sycl::plus<int64_t>());
+      int64_t sum_sq =
+          sycl::reduce_over_group(group, rgb[c] * rgb[c], sycl::plus<int64_t>());
+      if (lid == 0) {
+        sycl::atomic_ref<
+            int64_t,
+            sycl::memory_order::relaxed,
+            sycl::memory_scope::device,
+            sycl::access::address_space::global_space>(stats.channel_sums[c])
+            .fetch_add(sum);
+        sycl::atomic_ref<
+            int64_t,
+            sycl::memory_order::relaxed,
+            sycl::memory_scope::device,
+            sycl::access::address_space::global_space>(stats.channel_sums[3 + c])
+            .fetch_add(sum_sq);
+      }
+    }
+
+    sycl::group_barrier(group);
+    for (size_t i = lid; i < (size_t)LUMA_HISTOGRAM_BINS; i += group_size) {
+      if (local_histogram[i] != 0) {
+        sycl::atomic_ref<
+            int32_t,
+            sycl::memory_order::relaxed,
+            sycl::memory_scope::device,
+            sycl::access::address_space::global_space>(stats.luma_histogram[i])
+            .fetch_add((int32_t)local_histogram[i]);
+      }
+    }
+    for (size_t i = lid; i < window_size; i += group_size) {
+      // Cells outside of the thumbnail are never touched.
+      if (local_thumbnail[i] != 0) {
+        int c = i % 3;
+        int tx = window_x + (i / 3) % window_width;
+        int ty = window_y + (i / 3) / window_width;
+        sycl::atomic_ref<
+            int32_t,
+            sycl::memory_order::relaxed,
+            sycl::memory_scope::device,
+            sycl::access::address_space::global_space>(
+            stats.thumbnail_sums[3 * (ty * size + tx) + c])
+            .fetch_add((int32_t)local_thumbnail[i]);
+      }
+    }
+  }
+};
+
+// Turns channel sums into mean and variance, thumbnail cell sums into
+// thumbnail and computes average hash of the thumbnail. Works on few
+// kilobytes of data, so single task is enough.
+struct FinalizeFrameStatisticsKernel {
+  FrameStatisticsBuffers stats;
+  int width;
+  int height;
+
+  FinalizeFrameStatisticsKernel(
+      const FrameStatisticsBuffers &stats,
+      int width,
+      int height):
+    stats(stats),
+    width(width),
+    height(height)
+  {}
+
+  void operator()() const {
+    int64_t num_pixels = (int64_t)width * height;
+    for (int c = 0; c < 3; ++c) {
+      float mean = (float)stats.channel_sums[c] / num_pixels;
+      float mean_sq = (float)stats.channel_sums[3 + c] / num_pixels;
+      stats.channel_mean[c] = mean;
+      stats.channel_variance[c] = sycl::fmax(mean_sq - mean * mean, 0.0f);
+    }
+
+    int size = stats.thumbnail_size;
+    for (int ty = 0; ty < size; ++ty) {
+      int cell_height = thumbnail_cell_end(ty, height, size) -
+          thumbnail_cell_begin(ty, height, size);
+      for (int tx = 0; tx < size; ++tx) {
+        int cell_width = thumbnail_cell_end(tx, width, size) -
+            thumbnail_cell_begin(tx, width, size);
+        int cell_pixels = cell_width * cell_height;
+        for (int c = 0; c < 3; ++c) {
+          int idx = 3 * (ty * size + tx) + c;
+          stats.thumbnail[idx] =
+              (uint8_t)((stats.thumbnail_sums[idx] + cell_pixels / 2) / cell_pixels);
+        }
+      }
+    }
+
+    // Average hash: 8x8 grid of mean thumbnail luma values compared against
+    // their mean.
+    const int grid = PERCEPTUAL_HASH_SIZE;
+    int block = stats.thumbnail_size / grid;
+    uint32_t cells[grid * grid];
+    uint32_t total = 0;
+    for (int gy = 0; gy < grid; ++gy) {
+      for (int gx = 0; gx < grid; ++gx) {
+        uint32_t cell = 0;
+        for (int y = gy * block; y < (gy + 1) * block; ++y) {
+          for (int x = gx * block; x < (gx + 1) * block; ++x) {
+            const uint8_t* p = stats.thumbnail + 3 * (y * stats.thumbnail_size + x);
+            // BT.709 luma weights in 8-bit fixed point.
+            cell += (54 * p[0] + 183 * p[1] + 19 * p[2]) >> 8;
+          }
+        }
+        cells[gy * grid + gx] = cell;
+        total += cell;
+      }
+    }
+
+    uint64_t hash = 0;
+    for (int i = 0; i < grid * grid; ++i) {
+      if ((uint64_t)cells[i] * grid * grid > total) {
+        hash |= (uint64_t)1 << i;
+      }
+    }
+    stats.perceptual_hash[0] = (int64_t)hash;
+  }
+};
+
+sycl::event submitNV12ToRGB(
     sycl::queue& queue,
     const uint8_t* y_plane,
     const uint8_t* uv_plane,
@@ -165,8 +460,10 @@ void convertNV12ToRGB(
     int width,
     int height,
     int stride,
-    bool fullrange) {
-  queue.submit([&](sycl::handler& cgh) {
+    bool fullrange,
+    const std::vector<sycl::event>& deps) {
+  return queue.submit([&](sycl::handler& cgh) {
+    cgh.depends_on(deps);
     NV12toRGBKernel kernel(
       y_plane, uv_plane, rgb_output,
       width, height, stride,
@@ -176,6 +473,73 @@ void convertNV12ToRGB(
         sycl::range<2>(height, width),
         kernel);
   });
+}
+
+void convertNV12ToRGB(
+    sycl::queue& queue,
+    const uint8_t* y_plane,
+    const uint8_t* uv_plane,
+    uint8_t* rgb_output,
+    int width,
+    int height,
+    int stride,
+    bool fullrange) {
+  submitNV12ToRGB(
+      queue, y_plane, uv_plane, rgb_output, width, height, stride, fullrange, {});
+
+  queue.wait();
+}
+
+void convertNV12ToRGBWithStatistics(
+    sycl::queue& queue,
+    const uint8_t* y_plane,
+    const uint8_t* uv_plane,
+    uint8_t* rgb_output,
+    int width,
+    int height,
+    int stride,
+    bool fullrange,
+    const FrameStatisticsBuffers& stats) {
+  const size_t WG_SIZE = 16;
+  sycl::range<2> local(WG_SIZE, WG_SIZE);
+  sycl::range<2> global(
+      (height + WG_SIZE - 1) / WG_SIZE * WG_SIZE,
+      (width + WG_SIZE - 1) / WG_SIZE * WG_SIZE);
+
+  size_t thumbnail_sums_bytes =
+      3 * stats.thumbnail_size * stats.thumbnail_size * sizeof(int32_t);
+  std::vector<sycl::event> cleared = {
+      queue.memset(
+          stats.luma_histogram, 0, LUMA_HISTOGRAM_BINS * sizeof(int32_t)),
+      queue.memset(stats.channel_sums, 0, 6 * sizeof(int64_t)),
+      queue.memset(stats.thumbnail_sums, 0, thumbnail_sums_bytes)};
+
+  int window_width =
+      thumbnail_cells_per_group(width, stats.thumbnail_size, WG_SIZE);
+  int window_height =
+      thumbnail_cells_per_group(height, stats.thumbnail_size, WG_SIZE);
+
+  sycl::event converted = queue.submit([&](sycl::handler& cgh) {
+    cgh.depends_on(cleared);
+    sycl::local_accessor<uint32_t, 1> local_histogram(
+        sycl::range<1>(LUMA_HISTOGRAM_BINS), cgh);
+    sycl::local_accessor<uint32_t, 1> local_thumbnail(
+        sycl::range<1>(3 * window_width * window_height), cgh);
+    NV12toRGBStatisticsKernel kernel(
+      y_plane, uv_plane, rgb_output,
+      width, height, stride,
+      fullrange, rgb_matrix_bt709,
+      stats, local_histogram,
+      local_thumbnail, window_width, window_height);
+
+    cgh.parallel_for(sycl::nd_range<2>(global, local), kernel);
+  });
+
+  queue.submit([&](sycl::handler& cgh) {
+    cgh.depends_on(converted);
+    cgh.single_task(
+        FinalizeFrameStatisticsKernel(stats, width, height));
+  });
 
   queue.wait();
 }
@@ -188,6 +552,10 @@ void registerColorConversionKernel() {
   // We use volatile to prevent optimization.
   volatile size_t s = sizeof(NV12toRGBKernel);
   (void)s;
+  volatile size_t s_stats = sizeof(NV12toRGBStatisticsKernel);
+  (void)s_stats;
+  volatile size_t s_finalize = sizeof(FinalizeFrameStatisticsKernel);
+  (void)s_finalize;
 }
 
 } // namespace facebook::torchcodec
@@ -2,13 +2,28 @@
 
 #pragma once
 
+#include <cstdint>
+
+namespace facebook::torchcodec {
+
+const int LUMA_HISTOGRAM_BINS = 256;
+// Perceptual hash is computed over PERCEPTUAL_HASH_SIZE x PERCEPTUAL_HASH_SIZE
+// grid, so it fits into 64 bits.
+const int PERCEPTUAL_HASH_SIZE = 8;
+
+} // namespace facebook::torchcodec
+
 #ifdef WITH_SYCL_KERNELS
 
+#include <vector>
+
 #include <sycl/sycl.hpp>
-#include <cstdint>
 
 namespace facebook::torchcodec {
 
+// Offset of the byte at (x, y) within Intel Y-tiled plane with given stride.
+size_t get_tile_offset(int x, int y, int stride);
+
 void convertNV12ToRGB(
     sycl::queue& queue,
     const uint8_t* y_plane,
@@ -19,6 +34,44 @@ void convertNV12ToRGB(
     int stride,
     bool fullrange = 1);
 
+// Same as convertNV12ToRGB(), but returns without waiting for conversion
+// to complete. Conversion starts after deps complete.
+sycl::event submitNV12ToRGB(
+    sycl::queue& queue,
+    const uint8_t* y_plane,
+    const uint8_t* uv_plane,
+    uint8_t* rgb_output,
+    int width,
+    int height,
+    int stride,
+    bool fullrange,
+    const std::vector<sycl::event>& deps);
+
+// Device buffers for per-frame statistics. Thumbnail size should be a
+// multiple of PERCEPTUAL_HASH_SIZE.
+struct FrameStatisticsBuffers {
+  int32_t* luma_histogram;   // [LUMA_HISTOGRAM_BINS]
+  int64_t* channel_sums;     // [6], R, G, B sums, then sums of squares
+  float* channel_mean;       // [3]
+  float* channel_variance;   // [3]
+  uint8_t* thumbnail;        // [thumbnail_size, thumbnail_size, 3]
+  int32_t* thumbnail_sums;   // [thumbnail_size, thumbnail_size, 3], scratch
+  int thumbnail_size;
+  int64_t* perceptual_hash;  // [1]
+};
+
+// Converts NV12 to RGB and collects frame statistics in the same pass.
+void convertNV12ToRGBWithStatistics(
+    sycl::queue& queue,
+    const uint8_t* y_plane,
+    const uint8_t* uv_plane,
+    uint8_t* rgb_output,
+    int width,
+    int height,
+    int stride,
+    bool fullrange,
+    const FrameStatisticsBuffers& stats);
+
 // Anchor function to force kernel registration
 void registerColorConversionKernel();
 
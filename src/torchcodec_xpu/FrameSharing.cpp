@@ -0,0 +1,277 @@
+// Copyright (c) 2025 Dmitry Rogozhkin.
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+#include <level_zero/ze_api.h>
+
+#include <c10/util/accumulate.h>
+#include <c10/xpu/XPUFunctions.h>
+#include <c10/xpu/XPUStream.h>
+
+#include "FrameSharing.h"
+#include "SurfaceSource.h"
+
+namespace facebook::torchcodec {
+
+namespace {
+
+// Number of free allocations of each size kept by ShareableMemoryPool.
+const size_t MAX_POOLED_SHAREABLE_ALLOCATIONS = 8;
+
+// Exportable allocations are not managed by the caching allocator, so we
+// keep our own pool to avoid driver allocation per decoded frame. Memory is
+// reused in order of the current stream, same as with caching allocator.
+class ShareableMemoryPool {
+ public:
+  void* acquire(
+      ze_context_handle_t zeCtx,
+      ze_device_handle_t zeDevice,
+      int64_t size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<void*>& buffers = freeBuffers_[{zeCtx, zeDevice, size}];
+    if (buffers.empty()) {
+      return nullptr;
+    }
+    void* ptr = buffers.back();
+    buffers.pop_back();
+    return ptr;
+  }
+
+  void release(
+      ze_context_handle_t zeCtx,
+      ze_device_handle_t zeDevice,
+      int64_t size,
+      void* ptr) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      std::vector<void*>& buffers = freeBuffers_[{zeCtx, zeDevice, size}];
+      if (buffers.size() < MAX_POOLED_SHAREABLE_ALLOCATIONS) {
+        buffers.push_back(ptr);
+        return;
+      }
+    }
+    zeMemFree(zeCtx, ptr);
+  }
+
+ private:
+  std::mutex mutex_;
+  std::map<
+      std::tuple<ze_context_handle_t, ze_device_handle_t, int64_t>,
+      std::vector<void*>>
+      freeBuffers_;
+};
+
+ShareableMemoryPool& getShareableMemoryPool() {
+  // Never destroyed: Level Zero might be torn down by then.
+  static auto* pool = new ShareableMemoryPool();
+  return *pool;
+}
+
+// Owns Level Zero allocation backing shareable or imported tensor.
+struct sharedMemoryCtx {
+  void* ptr = nullptr;
+  ze_context_handle_t zeCtx = nullptr;
+  ze_device_handle_t zeDevice = nullptr;
+  int64_t size = 0;
+  // Allocated by allocateShareableTensor() rather than imported.
+  bool pooled = false;
+  // Once exported, memory might be used by importers for as long as they
+  // wish and we can't know when they are done, so it's never reused.
+  std::atomic<bool> exported{false};
+};
+
+void deleteSharedMemory(void* ctx) {
+  std::unique_ptr<sharedMemoryCtx> context((sharedMemoryCtx*)ctx);
+  if (context->pooled && !context->exported) {
+    getShareableMemoryPool().release(
+        context->zeCtx, context->zeDevice, context->size, context->ptr);
+  } else {
+    zeMemFree(context->zeCtx, context->ptr);
+  }
+}
+
+torch::Device withIndex(const torch::Device& device) {
+  TORCH_CHECK(
+      device.type() == torch::kXPU, "Expected XPU device, got ", device.str());
+  if (device.has_index()) {
+    return device;
+  }
+  return torch::Device(torch::kXPU, c10::xpu::current_device());
+}
+
+// Wraps Level Zero allocation into XPU tensor. Tensor takes ownership of
+// the allocation.
+torch::Tensor wrapSharedMemory(
+    const torch::Device& device,
+    const LevelZeroHandles& handles,
+    void* ptr,
+    int64_t size,
+    bool pooled,
+    int64_t offset,
+    at::IntArrayRef sizes,
+    at::IntArrayRef strides) {
+  auto context = std::make_unique<sharedMemoryCtx>();
+  context->ptr = ptr;
+  context->zeCtx = handles.context;
+  context->zeDevice = handles.device;
+  context->size = size;
+  context->pooled = pooled;
+
+  c10::DataPtr dataPtr(ptr, context.release(), &deleteSharedMemory, device);
+  c10::Storage storage(
+      c10::Storage::use_byte_size_t(),
+      size,
+      std::move(dataPtr),
+      /*allocator=*/nullptr,
+      /*resizable=*/false);
+  return torch::empty(
+             {0}, torch::TensorOptions().dtype(torch::kUInt8).device(device))
+      .set_(storage, offset, sizes, strides);
+}
+
+bool isShareable(const torch::Tensor& frame) {
+  return frame.storage().data_ptr().get_deleter() == &deleteSharedMemory;
+}
+
+} // namespace
+
+torch::Tensor allocateShareableTensor(
+    const torch::Device& device,
+    at::IntArrayRef sizes) {
+  torch::Device xpuDevice = withIndex(device);
+  sycl::queue queue = c10::xpu::getCurrentXPUStream(xpuDevice.index());
+  LevelZeroHandles handles = getLevelZeroHandles(queue);
+
+  ze_external_memory_export_desc_t export_desc{};
+  export_desc.stype = ZE_STRUCTURE_TYPE_EXTERNAL_MEMORY_EXPORT_DESC;
+  export_desc.flags = ZE_EXTERNAL_MEMORY_TYPE_FLAG_DMA_BUF;
+
+  ze_device_mem_alloc_desc_t alloc_desc{};
+  alloc_desc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
+  alloc_desc.pNext = &export_desc;
+
+  int64_t size = c10::multiply_integers(sizes);
+  void* ptr =
+      getShareableMemoryPool().acquire(handles.context, handles.device, size);
+  if (ptr == nullptr) {
+    ze_result_t res = zeMemAllocDevice(
+        handles.context, &alloc_desc, size, 0, handles.device, &ptr);
+    TORCH_CHECK(
+        res == ZE_RESULT_SUCCESS,
+        "Failed to allocate ",
+        size,
+        " bytes of shareable memory");
+  }
+
+  // Empty strides make contiguous tensor.
+  return wrapSharedMemory(
+      xpuDevice,
+      handles,
+      ptr,
+      size,
+      /*pooled=*/true,
+      /*offset=*/0,
+      sizes,
+      /*strides=*/{});
+}
+
+ExportedFrame exportFrame(const torch::Tensor& frame) {
+  TORCH_CHECK(
+      frame.device().type() == torch::kXPU,
+      "Expected XPU tensor, got ",
+      frame.device().str());
+  TORCH_CHECK(
+      frame.scalar_type() == torch::kUInt8,
+      "Expected uint8 tensor, got ",
+      frame.scalar_type());
+
+  torch::Tensor shareable = frame;
+  if (!isShareable(frame)) {
+    shareable = allocateShareableTensor(frame.device(), frame.sizes());
+    shareable.copy_(frame);
+  }
+  // Importer might access memory right away and it knows nothing about
+  // our streams.
+  c10::xpu::getCurrentXPUStream(frame.device().index()).synchronize();
+
+  auto* context =
+      (sharedMemoryCtx*)shareable.storage().data_ptr().get_context();
+
+  ze_external_memory_export_fd_t export_fd{};
+  export_fd.stype = ZE_STRUCTURE_TYPE_EXTERNAL_MEMORY_EXPORT_FD;
+  export_fd.flags = ZE_EXTERNAL_MEMORY_TYPE_FLAG_DMA_BUF;
+
+  ze_memory_allocation_properties_t props{};
+  props.stype = ZE_STRUCTURE_TYPE_MEMORY_ALLOCATION_PROPERTIES;
+  props.pNext = &export_fd;
+
+  ze_result_t res =
+      zeMemGetAllocProperties(context->zeCtx, context->ptr, &props, nullptr);
+  TORCH_CHECK(
+      res == ZE_RESULT_SUCCESS, "Failed to export frame memory as dma-buf");
+  context->exported = true;
+
+  ExportedFrame exported;
+  exported.fd = export_fd.fd;
+  exported.size = shareable.storage().nbytes();
+  exported.offset = shareable.storage_offset();
+  exported.strides = shareable.strides().vec();
+  return exported;
+}
+
+torch::Tensor importFrame(
+    const torch::Device& device,
+    const ExportedFrame& exported,
+    at::IntArrayRef sizes) {
+  TORCH_CHECK(
+      sizes.size() == exported.strides.size(),
+      "Expected ",
+      sizes.size(),
+      " strides, got ",
+      exported.strides.size());
+  // Offset of the last element plus one.
+  int64_t end = exported.offset + 1;
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    TORCH_CHECK(
+        exported.strides[i] >= 0,
+        "Negative strides are not supported, got ",
+        exported.strides);
+    if (sizes[i] == 0) {
+      end = exported.offset;
+      break;
+    }
+    end += (sizes[i] - 1) * exported.strides[i];
+  }
+  TORCH_CHECK(
+      end <= exported.size,
+      "Frame of shape ",
+      sizes,
+      " with strides ",
+      exported.strides,
+      " at offset ",
+      exported.offset,
+      " does not fit into ",
+      exported.size,
+      " bytes");
+
+  torch::Device xpuDevice = withIndex(device);
+  sycl::queue queue = c10::xpu::getCurrentXPUStream(xpuDevice.index());
+  LevelZeroHandles handles = getLevelZeroHandles(queue);
+  void* ptr = importDmaBuf(handles, exported.fd, exported.size);
+
+  return wrapSharedMemory(
+      xpuDevice,
+      handles,
+      ptr,
+      exported.size,
+      /*pooled=*/false,
+      exported.offset,
+      sizes,
+      exported.strides);
+}
+
+} // namespace facebook::torchcodec
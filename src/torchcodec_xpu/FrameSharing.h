@@ -0,0 +1,41 @@
+// Copyright (c) 2025 Dmitry Rogozhkin.
+
+#pragma once
+
+#include <vector>
+
+#include <torch/types.h>
+
+namespace facebook::torchcodec {
+
+// Frames can be shared between processes as dma-buf file descriptors.
+// Memory stays alive as long as there is an open descriptor or an importing
+// tensor, so exporting process may release the frame right after export.
+struct ExportedFrame {
+  int fd = -1; // owned by the caller
+  int64_t size = 0; // size of the underlying allocation
+  int64_t offset = 0; // offset of the frame data within the allocation
+  std::vector<int64_t> strides; // frame strides in elements
+};
+
+// Allocates uint8 XPU tensor in Level Zero memory exportable as dma-buf.
+// Memory of tensors which were never exported is reused by the next calls,
+// memory of exported ones is released once the tensor is deleted.
+torch::Tensor allocateShareableTensor(
+    const torch::Device& device,
+    at::IntArrayRef sizes);
+
+// Exports frame as dma-buf. Views of tensors allocated with
+// allocateShareableTensor() (for example, permuted frames) are exported
+// as is. Other frames are copied into shareable memory first since caching
+// allocator would reuse their memory behind importer's back.
+ExportedFrame exportFrame(const torch::Tensor& frame);
+
+// Imports frame exported by exportFrame(), possibly in another process,
+// as a view with the exported strides. Caller keeps ownership of the fd.
+torch::Tensor importFrame(
+    const torch::Device& device,
+    const ExportedFrame& exported,
+    at::IntArrayRef sizes);
+
+} // namespace facebook::torchcodec
@@ -0,0 +1,73 @@
+// Copyright (c) 2025 Dmitry Rogozhkin.
+
+#include <atomic>
+#include <deque>
+#include <iterator>
+
+#include "FrameStatistics.h"
+
+namespace facebook::torchcodec {
+
+namespace {
+
+thread_local std::deque<FrameStatistics> g_recorded_frame_statistics;
+thread_local size_t g_dropped_frame_statistics = 0;
+thread_local int64_t g_last_decoder_id = -1;
+
+std::atomic<int64_t> g_next_decoder_id{0};
+
+} // namespace
+
+FrameStatistics allocateFrameStatistics(SurfaceSource& surfaceSource) {
+  FrameStatistics stats;
+  stats.lumaHistogram =
+      surfaceSource.allocateTensor({LUMA_HISTOGRAM_BINS}, torch::kInt32);
+  stats.channelMean = surfaceSource.allocateTensor({3}, torch::kFloat32);
+  stats.channelVariance = surfaceSource.allocateTensor({3}, torch::kFloat32);
+  stats.thumbnail = surfaceSource.allocateTensor(
+      {THUMBNAIL_SIZE, THUMBNAIL_SIZE, 3}, torch::kUInt8);
+  stats.perceptualHash = surfaceSource.allocateTensor({}, torch::kInt64);
+  stats.channelSums = surfaceSource.allocateTensor({6}, torch::kInt64);
+  stats.thumbnailSums = surfaceSource.allocateTensor(
+      {THUMBNAIL_SIZE, THUMBNAIL_SIZE, 3}, torch::kInt32);
+  return stats;
+}
+
+void recordFrameStatistics(FrameStatistics&& stats) {
+  // Scratch is not needed past conversion.
+  stats.channelSums = torch::Tensor();
+  stats.thumbnailSums = torch::Tensor();
+  if (g_recorded_frame_statistics.size() >= MAX_RECORDED_FRAME_STATISTICS) {
+    g_recorded_frame_statistics.pop_front();
+    ++g_dropped_frame_statistics;
+  }
+  g_recorded_frame_statistics.push_back(std::move(stats));
+}
+
+std::vector<FrameStatistics> takeFrameStatistics() {
+  if (g_dropped_frame_statistics > 0) {
+    TORCH_WARN(
+        "Statistics of ",
+        g_dropped_frame_statistics,
+        " frames were dropped since they were not picked up in time, only ",
+        MAX_RECORDED_FRAME_STATISTICS,
+        " most recent entries are kept");
+    g_dropped_frame_statistics = 0;
+  }
+  std::vector<FrameStatistics> stats(
+      std::make_move_iterator(g_recorded_frame_statistics.begin()),
+      std::make_move_iterator(g_recorded_frame_statistics.end()));
+  g_recorded_frame_statistics.clear();
+  return stats;
+}
+
+int64_t acquireDecoderId() {
+  g_last_decoder_id = g_next_decoder_id++;
+  return g_last_decoder_id;
+}
+
+int64_t getLastDecoderId() {
+  return g_last_decoder_id;
+}
+
+} // namespace facebook::torchcodec
@@ -0,0 +1,55 @@
+// Copyright (c) 2025 Dmitry Rogozhkin.
+
+#pragma once
+
+#include <vector>
+
+#include <torch/types.h>
+
+#include "ColorConversionKernel.h"
+#include "SurfaceSource.h"
+
+namespace facebook::torchcodec {
+
+// Thumbnail is THUMBNAIL_SIZE x THUMBNAIL_SIZE RGB image.
+const int THUMBNAIL_SIZE = 32;
+
+// Side outputs of the color conversion used to filter out near-duplicate
+// frames and detect scene changes without re-reading converted frames.
+// Tensors are allocated on the device frames are converted on.
+struct FrameStatistics {
+  // Identifies decoder the frame came from, see getLastDecoderId().
+  int64_t decoderId = 0;
+  double ptsSeconds = 0;
+  torch::Tensor lumaHistogram; // int32 [LUMA_HISTOGRAM_BINS]
+  torch::Tensor channelMean; // float32 [3]
+  torch::Tensor channelVariance; // float32 [3]
+  // uint8 [THUMBNAIL_SIZE, THUMBNAIL_SIZE, 3], each pixel is the average
+  // of the frame area it covers
+  torch::Tensor thumbnail;
+  torch::Tensor perceptualHash; // int64 [], 8x8 average hash
+  torch::Tensor channelSums; // int64 [6], scratch
+  torch::Tensor thumbnailSums; // int32 [THUMBNAIL_SIZE, THUMBNAIL_SIZE, 3], scratch
+};
+
+FrameStatistics allocateFrameStatistics(SurfaceSource& surfaceSource);
+
+// Statistics are recorded per thread so that caller can pick them up
+// after decoding call returns. Only MAX_RECORDED_FRAME_STATISTICS most
+// recent entries are kept.
+const size_t MAX_RECORDED_FRAME_STATISTICS = 1024;
+
+void recordFrameStatistics(FrameStatistics&& stats);
+
+// Returns statistics recorded on the calling thread since the last call.
+// Warns if some entries were dropped since the last call.
+std::vector<FrameStatistics> takeFrameStatistics();
+
+// Each XPU device interface (one per decoder) gets a process-wide unique id
+// which is recorded along with frame statistics.
+int64_t acquireDecoderId();
+
+// Returns id of the decoder most recently created on the calling thread.
+int64_t getLastDecoderId();
+
+} // namespace facebook::torchcodec
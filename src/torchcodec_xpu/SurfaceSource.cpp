@@ -0,0 +1,336 @@
+// Copyright (c) 2025 Dmitry Rogozhkin.
+
+#include <unistd.h>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <ATen/Parallel.h>
+#include <c10/util/accumulate.h>
+#include <c10/xpu/XPUStream.h>
+#include <va/va_drmcommon.h>
+
+#include "ColorConversionKernel.h"
+#include "SurfaceSource.h"
+
+extern "C" {
+#include <libavutil/hwcontext_vaapi.h>
+#include <libavutil/pixdesc.h>
+}
+
+namespace facebook::torchcodec {
+
+VADisplay getVaDisplayFromAV(AVFrame* avFrame) {
+  AVHWFramesContext* hwfc = (AVHWFramesContext*)avFrame->hw_frames_ctx->data;
+  AVHWDeviceContext* hwdc = hwfc->device_ctx;
+  AVVAAPIDeviceContext* vactx = (AVVAAPIDeviceContext*)hwdc->hwctx;
+  return vactx->display;
+}
+
+LevelZeroHandles getLevelZeroHandles(sycl::queue& queue) {
+  LevelZeroHandles handles;
+  queue
+      .submit([&](sycl::handler& cgh) {
+        cgh.host_task([&](const sycl::interop_handle& ih) {
+          handles.context =
+              ih.get_native_context<sycl::backend::ext_oneapi_level_zero>();
+          handles.device =
+              ih.get_native_device<sycl::backend::ext_oneapi_level_zero>();
+        });
+      })
+      .wait();
+  return handles;
+}
+
+void* importDmaBuf(const LevelZeroHandles& handles, int fd, size_t size) {
+  ze_external_memory_import_fd_t import_fd_desc{};
+  import_fd_desc.stype = ZE_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMPORT_FD;
+  import_fd_desc.flags = ZE_EXTERNAL_MEMORY_TYPE_FLAG_DMA_BUF;
+  import_fd_desc.fd = fd;
+
+  ze_device_mem_alloc_desc_t alloc_desc{};
+  alloc_desc.pNext = &import_fd_desc;
+  void* usm_ptr = nullptr;
+
+  ze_result_t res = zeMemAllocDevice(
+      handles.context, &alloc_desc, size, 0, handles.device, &usm_ptr);
+  TORCH_CHECK(res == ZE_RESULT_SUCCESS, "Failed to import fd=", fd);
+  return usm_ptr;
+}
+
+bool isAccessibleFromQueue(const sycl::queue& queue, const torch::Tensor& t) {
+  if (!t.is_contiguous()) {
+    return false;
+  }
+  return sycl::get_pointer_type(t.data_ptr(), queue.get_context()) !=
+      sycl::usm::alloc::unknown;
+}
+
+namespace {
+
+class VaapiSurfaceSource : public SurfaceSource {
+ public:
+  explicit VaapiSurfaceSource(const torch::Device& device) : device_(device) {}
+
+  bool usesHardwareDecoding() const override {
+    return true;
+  }
+
+  sycl::queue getQueue() override {
+    return c10::xpu::getCurrentXPUStream(device_.index());
+  }
+
+  std::unique_ptr<TiledNV12Surface> map(const UniqueAVFrame& frame) override {
+    TORCH_CHECK_EQ(frame->format, AV_PIX_FMT_VAAPI);
+    VADRMPRIMESurfaceDescriptor desc{};
+    VAStatus sts = vaExportSurfaceHandle(
+        getVaDisplayFromAV(frame.get()),
+        (VASurfaceID)(uintptr_t)frame->data[3],
+        VA_SURFACE_ATTRIB_MEM_TYPE_DRM_PRIME_2,
+        VA_EXPORT_SURFACE_READ_ONLY,
+        &desc);
+    TORCH_CHECK(
+        sts == VA_STATUS_SUCCESS,
+        "vaExportSurfaceHandle failed: ",
+        vaErrorStr(sts));
+
+    TORCH_CHECK(desc.num_objects == 1, "Expected 1 fd, got ", desc.num_objects);
+
+    sycl::queue queue = getQueue();
+    LevelZeroHandles handles = getLevelZeroHandles(queue);
+    void* usm_ptr =
+        importDmaBuf(handles, desc.objects[0].fd, desc.objects[0].size);
+    close(desc.objects[0].fd);
+
+    auto surface = std::make_unique<TiledNV12Surface>();
+    surface->yPlane = (uint8_t*)usm_ptr + desc.layers[0].offset[0];
+    surface->uvPlane = (uint8_t*)usm_ptr + desc.layers[1].offset[0];
+    surface->width = frame->width;
+    surface->height = frame->height;
+    surface->pitch = desc.layers[0].pitch[0];
+    surface->release = [zeCtx = handles.context, usm_ptr]() {
+      zeMemFree(zeCtx, usm_ptr);
+    };
+    return surface;
+  }
+
+  torch::Tensor allocateTensor(
+      at::IntArrayRef sizes,
+      torch::ScalarType dtype) override {
+    return torch::empty(
+        sizes, torch::TensorOptions().dtype(dtype).device(device_));
+  }
+
+ private:
+  torch::Device device_;
+};
+
+#ifdef WITH_SYCL_KERNELS
+
+// Intel Y-tile dimensions, see get_tile_offset().
+const int TILE_WIDTH = 128;
+const int TILE_HEIGHT = 32;
+
+inline int alignUp(int value, int alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+// Number of free allocations of each size kept by HostAllocationPool.
+const size_t MAX_POOLED_HOST_ALLOCATIONS = 16;
+
+// Host USM allocations backing output and statistics tensors of emulated
+// source. Tensors may outlive the source, so their deleters share ownership
+// of the pool.
+class HostAllocationPool {
+ public:
+  explicit HostAllocationPool(sycl::queue queue) : queue_(std::move(queue)) {}
+
+  ~HostAllocationPool() {
+    for (auto& [size, buffers] : freeBuffers_) {
+      for (void* buffer : buffers) {
+        sycl::free(buffer, queue_);
+      }
+    }
+  }
+
+  void* acquire(size_t size) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      std::vector<void*>& buffers = freeBuffers_[size];
+      if (!buffers.empty()) {
+        void* buffer = buffers.back();
+        buffers.pop_back();
+        return buffer;
+      }
+    }
+    void* buffer = sycl::malloc_host(size, queue_);
+    TORCH_CHECK(buffer != nullptr, "Failed to allocate ", size, " bytes");
+    return buffer;
+  }
+
+  void release(void* buffer, size_t size) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      std::vector<void*>& buffers = freeBuffers_[size];
+      if (buffers.size() < MAX_POOLED_HOST_ALLOCATIONS) {
+        buffers.push_back(buffer);
+        return;
+      }
+    }
+    sycl::free(buffer, queue_);
+  }
+
+ private:
+  sycl::queue queue_;
+  std::mutex mutex_;
+  std::unordered_map<size_t, std::vector<void*>> freeBuffers_;
+};
+
+// Host memory stand-in for VAAPI surfaces. Software decoded frames are
+// tiled the same way as Intel media driver lays out NV12 surfaces so
+// conversion kernels see exactly the same data as on real hardware.
+class EmulatedSurfaceSource : public SurfaceSource {
+ public:
+  EmulatedSurfaceSource()
+      : queue_(sycl::cpu_selector_v),
+        tensorPool_(std::make_shared<HostAllocationPool>(queue_)) {
+    VLOG(1) << "Emulated surfaces on SYCL device: "
+            << queue_.get_device().get_info<sycl::info::device::name>();
+  }
+
+  ~EmulatedSurfaceSource() override {
+    for (uint8_t* buffer : freeBuffers_) {
+      sycl::free(buffer, queue_);
+    }
+  }
+
+  bool usesHardwareDecoding() const override {
+    return false;
+  }
+
+  sycl::queue getQueue() override {
+    return queue_;
+  }
+
+  std::unique_ptr<TiledNV12Surface> map(const UniqueAVFrame& frame) override {
+    TORCH_CHECK(
+        frame->format == AV_PIX_FMT_NV12 || frame->format == AV_PIX_FMT_YUV420P,
+        "Emulated surfaces support only NV12 and YUV420P frames, got ",
+        av_get_pix_fmt_name((AVPixelFormat)frame->format));
+
+    int width = frame->width;
+    int height = frame->height;
+    int chromaWidth = (width + 1) / 2;
+    int chromaHeight = (height + 1) / 2;
+    // Interleaved chroma row is 2 * chromaWidth bytes which is wider than
+    // luma row for odd widths.
+    int pitch = alignUp(2 * chromaWidth, TILE_WIDTH);
+    size_t lumaSize = (size_t)pitch * alignUp(height, TILE_HEIGHT);
+    size_t size = lumaSize + (size_t)pitch * alignUp(chromaHeight, TILE_HEIGHT);
+
+    uint8_t* buffer = acquireBuffer(size);
+    uint8_t* yPlane = buffer;
+    uint8_t* uvPlane = buffer + lumaSize;
+
+    at::parallel_for(0, height, 0, [&](int64_t begin, int64_t end) {
+      for (int y = begin; y < end; ++y) {
+        const uint8_t* src = frame->data[0] + (size_t)y * frame->linesize[0];
+        for (int x = 0; x < width; ++x) {
+          yPlane[get_tile_offset(x, y, pitch)] = src[x];
+        }
+      }
+    });
+
+    bool isNV12 = frame->format == AV_PIX_FMT_NV12;
+    at::parallel_for(0, chromaHeight, 0, [&](int64_t begin, int64_t end) {
+      for (int y = begin; y < end; ++y) {
+        for (int x = 0; x < chromaWidth; ++x) {
+          uint8_t u = isNV12
+              ? frame->data[1][(size_t)y * frame->linesize[1] + 2 * x]
+              : frame->data[1][(size_t)y * frame->linesize[1] + x];
+          uint8_t v = isNV12
+              ? frame->data[1][(size_t)y * frame->linesize[1] + 2 * x + 1]
+              : frame->data[2][(size_t)y * frame->linesize[2] + x];
+          uvPlane[get_tile_offset(2 * x, y, pitch)] = u;
+          uvPlane[get_tile_offset(2 * x + 1, y, pitch)] = v;
+        }
+      }
+    });
+
+    auto surface = std::make_unique<TiledNV12Surface>();
+    surface->yPlane = yPlane;
+    surface->uvPlane = uvPlane;
+    surface->width = width;
+    surface->height = height;
+    surface->pitch = pitch;
+    surface->release = [this, buffer, size]() { releaseBuffer(buffer, size); };
+    return surface;
+  }
+
+  torch::Tensor allocateTensor(
+      at::IntArrayRef sizes,
+      torch::ScalarType dtype) override {
+    size_t size = c10::multiply_integers(sizes) * c10::elementSize(dtype);
+    void* data = tensorPool_->acquire(size);
+    return torch::from_blob(
+        data,
+        sizes,
+        [pool = tensorPool_, size](void* ptr) { pool->release(ptr, size); },
+        torch::TensorOptions().dtype(dtype));
+  }
+
+ private:
+  uint8_t* acquireBuffer(size_t size) {
+    if (size != bufferSize_) {
+      for (uint8_t* buffer : freeBuffers_) {
+        sycl::free(buffer, queue_);
+      }
+      freeBuffers_.clear();
+      bufferSize_ = size;
+    }
+    if (!freeBuffers_.empty()) {
+      uint8_t* buffer = freeBuffers_.back();
+      freeBuffers_.pop_back();
+      return buffer;
+    }
+    uint8_t* buffer = sycl::malloc_host<uint8_t>(size, queue_);
+    TORCH_CHECK(buffer != nullptr, "Failed to allocate ", size, " bytes");
+    return buffer;
+  }
+
+  void releaseBuffer(uint8_t* buffer, size_t size) {
+    if (size == bufferSize_) {
+      freeBuffers_.push_back(buffer);
+    } else {
+      sycl::free(buffer, queue_);
+    }
+  }
+
+  sycl::queue queue_;
+  // Surfaces of the last seen size are reused across frames.
+  std::vector<uint8_t*> freeBuffers_;
+  size_t bufferSize_ = 0;
+  std::shared_ptr<HostAllocationPool> tensorPool_;
+};
+
+#endif // WITH_SYCL_KERNELS
+
+} // namespace
+
+std::unique_ptr<SurfaceSource> createVaapiSurfaceSource(
+    const torch::Device& device) {
+  return std::make_unique<VaapiSurfaceSource>(device);
+}
+
+std::unique_ptr<SurfaceSource> createEmulatedSurfaceSource() {
+#ifdef WITH_SYCL_KERNELS
+  return std::make_unique<EmulatedSurfaceSource>();
+#else
+  TORCH_CHECK(
+      false,
+      "Emulated surfaces require SYCL kernels, rebuild with CXX=icpx");
+  return nullptr;
+#endif
+}
+
+} // namespace facebook::torchcodec
@@ -0,0 +1,96 @@
+// Copyright (c) 2025 Dmitry Rogozhkin.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include <level_zero/ze_api.h>
+#include <sycl/sycl.hpp>
+#include <va/va.h>
+
+#include "FFMPEGCommon.h"
+#include "Frame.h"
+
+namespace facebook::torchcodec {
+
+// NV12 surface mapped into memory which is accessible from the queue of the
+// surface source it was mapped by. Both planes are stored in Intel Y-tiled
+// layout with the same pitch. Mapping is released on destruction.
+struct TiledNV12Surface {
+  const uint8_t* yPlane = nullptr;
+  const uint8_t* uvPlane = nullptr;
+  int width = 0;
+  int height = 0;
+  int pitch = 0;
+  std::function<void()> release;
+
+  TiledNV12Surface() = default;
+  TiledNV12Surface(const TiledNV12Surface&) = delete;
+  TiledNV12Surface& operator=(const TiledNV12Surface&) = delete;
+
+  ~TiledNV12Surface() {
+    if (release) {
+      release();
+    }
+  }
+};
+
+// Source of decoded surfaces for the color conversion pipeline.
+//
+// VAAPI source exports hardware surfaces as dma-bufs and imports them into
+// Level Zero. Emulated source stubs out export and import: it tiles software
+// decoded frames on the host into memory which a SYCL CPU device reads
+// directly, so dma-buf path is not exercised. It allows to run and time
+// conversion kernels and tensor output on systems without Intel GPU. Note
+// that map() of emulated source is much slower than the VAAPI one.
+class SurfaceSource {
+ public:
+  virtual ~SurfaceSource() = default;
+
+  // Whether decoder should be set up with VAAPI hardware device.
+  virtual bool usesHardwareDecoding() const = 0;
+
+  // Queue to submit conversion kernels to.
+  virtual sycl::queue getQueue() = 0;
+
+  virtual std::unique_ptr<TiledNV12Surface> map(
+      const UniqueAVFrame& avFrame) = 0;
+
+  // Allocates tensor writable from getQueue().
+  virtual torch::Tensor allocateTensor(
+      at::IntArrayRef sizes,
+      torch::ScalarType dtype) = 0;
+
+  // Allocates HWC output tensor writable from getQueue().
+  torch::Tensor allocateOutput(const FrameDims& frameDims) {
+    return allocateTensor(
+        {frameDims.height, frameDims.width, 3}, torch::kUInt8);
+  }
+};
+
+std::unique_ptr<SurfaceSource> createVaapiSurfaceSource(
+    const torch::Device& device);
+
+std::unique_ptr<SurfaceSource> createEmulatedSurfaceSource();
+
+// Checks whether kernels submitted to the queue can write to the tensor
+// memory directly.
+bool isAccessibleFromQueue(const sycl::queue& queue, const torch::Tensor& t);
+
+VADisplay getVaDisplayFromAV(AVFrame* avFrame);
+
+struct LevelZeroHandles {
+  ze_context_handle_t context = nullptr;
+  ze_device_handle_t device = nullptr;
+};
+
+LevelZeroHandles getLevelZeroHandles(sycl::queue& queue);
+
+// Imports dma-buf into Level Zero device memory. Caller owns returned
+// allocation and should release it with zeMemFree. Caller also keeps
+// ownership of the fd.
+void* importDmaBuf(const LevelZeroHandles& handles, int fd, size_t size);
+
+} // namespace facebook::torchcodec
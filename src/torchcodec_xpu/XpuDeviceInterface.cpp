@@ -2,6 +2,8 @@
 
 #include <unistd.h>
 #include <stdlib.h>
+#include <algorithm>
+#include <atomic>
 #include <string>
 #include <unordered_map>
 
@@ -14,6 +16,8 @@
 #include "ColorConversionKernel.h"
 #include "Cache.h"
 #include "FFMPEGCommon.h"
+#include "FrameSharing.h"
+#include "SurfaceSource.h"
 #include "XpuDeviceInterface.h"
 
 extern "C" {
@@ -28,6 +32,11 @@ namespace facebook::torchcodec {
 namespace {
 
 const char* USE_SYCL_KERNELS = std::getenv("USE_SYCL_KERNELS");
+const char* USE_EMULATED_SURFACES = std::getenv("USE_EMULATED_SURFACES");
+const char* USE_FRAME_STATISTICS = std::getenv("USE_FRAME_STATISTICS");
+const char* USE_HOST_OUTPUT = std::getenv("USE_HOST_OUTPUT");
+const char* USE_SHAREABLE_OUTPUT = std::getenv("USE_SHAREABLE_OUTPUT");
+const char* FILTER_GRAPH_CACHE_SIZE = std::getenv("FILTER_GRAPH_CACHE_SIZE");
 
 static bool g_xpu = registerDeviceInterface(
     DeviceInterfaceKey(torch::kXPU),
@@ -40,6 +49,18 @@ const int MAX_CONTEXTS_PER_GPU_IN_CACHE = -1;
 PerGpuCache<AVBufferRef, Deleterp<AVBufferRef, void, av_buffer_unref>>
     g_cached_hw_device_ctxs(MAX_XPU_GPUS, MAX_CONTEXTS_PER_GPU_IN_CACHE);
 
+// Number of filter graphs each decoder keeps unless overridden with
+// FILTER_GRAPH_CACHE_SIZE.
+const int DEFAULT_FILTER_GRAPH_CACHE_SIZE = 4;
+
+// Rows converted at once when converting to host memory. Multiple of 64, so
+// bands start at Y-tile row boundary (32 rows) of both luma and chroma
+// planes.
+const int HOST_OUTPUT_BAND_ROWS = 256;
+
+std::atomic<int64_t> g_filter_graph_cache_hits{0};
+std::atomic<int64_t> g_filter_graph_cache_rebuilds{0};
+
 inline bool to_bool(std::string str) {
     static const std::unordered_map<std::string, bool> bool_map = {
         {"1", true},  {"0", false},
@@ -66,6 +87,42 @@ inline bool use_sycl_color_conversion_kernel() {
 #endif
 }
 
+inline bool use_emulated_surfaces() {
+  if (!USE_EMULATED_SURFACES) {
+    return false;
+  }
+  return to_bool(USE_EMULATED_SURFACES);
+}
+
+inline bool use_frame_statistics() {
+  if (!USE_FRAME_STATISTICS) {
+    return false;
+  }
+  return to_bool(USE_FRAME_STATISTICS);
+}
+
+inline bool use_host_output() {
+  if (!USE_HOST_OUTPUT) {
+    return false;
+  }
+  return to_bool(USE_HOST_OUTPUT);
+}
+
+inline bool use_shareable_output() {
+  if (!USE_SHAREABLE_OUTPUT) {
+    return false;
+  }
+  return to_bool(USE_SHAREABLE_OUTPUT);
+}
+
+inline size_t filter_graph_cache_size() {
+  if (!FILTER_GRAPH_CACHE_SIZE) {
+    return DEFAULT_FILTER_GRAPH_CACHE_SIZE;
+  }
+  // Keep at least one graph, otherwise every frame would rebuild it.
+  return std::max(std::atoi(FILTER_GRAPH_CACHE_SIZE), 1);
+}
+
 UniqueAVBufferRef getVaapiContext(const torch::Device& device) {
   enum AVHWDeviceType type = av_hwdevice_find_type_by_name("vaapi");
   TORCH_CHECK(type != AV_HWDEVICE_TYPE_NONE, "Failed to find vaapi device");
@@ -96,8 +153,46 @@ UniqueAVBufferRef getVaapiContext(const torch::Device& device) {
   return UniqueAVBufferRef(ctx);
 }
 
+// Filter graph uses frames context of its input only to get the device and
+// software format of input surfaces. Decoder allocates new frames context
+// on every resolution change, so frames contexts are compared on these
+// rather than by identity.
+bool isCompatibleFramesCtx(const AVBufferRef* a, const AVBufferRef* b) {
+  if (a == nullptr || b == nullptr) {
+    return a == b;
+  }
+  auto* aFrames = (const AVHWFramesContext*)a->data;
+  auto* bFrames = (const AVHWFramesContext*)b->data;
+  return aFrames->device_ref->data == bFrames->device_ref->data &&
+      aFrames->sw_format == bFrames->sw_format;
+}
+
+// Unlike av_cmp_q() treats unset 0/0 values as equal.
+bool isSameRational(const AVRational& a, const AVRational& b) {
+  return a.num == b.num && a.den == b.den;
+}
+
+// Same as FiltersContext::operator== except for frames context comparison.
+bool canReuseFilterGraph(const FiltersContext& a, const FiltersContext& b) {
+  return a.inputWidth == b.inputWidth && a.inputHeight == b.inputHeight &&
+      a.inputFormat == b.inputFormat &&
+      isSameRational(a.inputAspectRatio, b.inputAspectRatio) &&
+      a.outputWidth == b.outputWidth && a.outputHeight == b.outputHeight &&
+      a.outputFormat == b.outputFormat &&
+      isSameRational(a.timeBase, b.timeBase) &&
+      a.filtergraphStr == b.filtergraphStr &&
+      isCompatibleFramesCtx(a.hwFramesCtx.get(), b.hwFramesCtx.get());
+}
+
 } // namespace
 
+FilterGraphCacheStats getFilterGraphCacheStats() {
+  FilterGraphCacheStats stats;
+  stats.hits = g_filter_graph_cache_hits.load();
+  stats.rebuilds = g_filter_graph_cache_rebuilds.load();
+  return stats;
+}
+
 int getDeviceIndex(const torch::Device& device) {
   // PyTorch uses int8_t as its torch::DeviceIndex, but FFmpeg and XPU
   // libraries use int. So we use int, too.
@@ -111,10 +206,22 @@ int getDeviceIndex(const torch::Device& device) {
 }
 
 XpuDeviceInterface::XpuDeviceInterface(const torch::Device& device)
-    : DeviceInterface(device) {
+    : DeviceInterface(device), decoderId_(acquireDecoderId()) {
   TORCH_CHECK(g_xpu, "XpuDeviceInterface was not registered!");
   TORCH_CHECK(
       device_.type() == torch::kXPU, "Unsupported device: ", device_.str());
+  TORCH_CHECK(
+      !(use_host_output() && use_shareable_output()),
+      "USE_HOST_OUTPUT and USE_SHAREABLE_OUTPUT are mutually exclusive");
+
+  if (use_emulated_surfaces()) {
+    TORCH_CHECK(
+        use_sycl_color_conversion_kernel(),
+        "Emulated surfaces require SYCL kernel backend");
+    surfaceSource_ = createEmulatedSurfaceSource();
+    VLOG(1) << "XpuDeviceInterface initialized with emulated surfaces";
+    return;
+  }
 
   // It is important for pytorch itself to create the xpu context. If ffmpeg
   // creates the context it may not be compatible with pytorch.
@@ -122,6 +229,11 @@ XpuDeviceInterface::XpuDeviceInterface(const torch::Device& device)
   torch::Tensor dummyTensorForXpuInitialization = torch::empty(
       {1}, torch::TensorOptions().dtype(torch::kUInt8).device(device_));
   ctx_ = getVaapiContext(device_);
+  surfaceSource_ = createVaapiSurfaceSource(device_);
+  if (use_host_output()) {
+    copyStream_ = c10::xpu::getStreamFromPool(
+        /*isHighPriority=*/false, device_.index());
+  }
 
   if (use_sycl_color_conversion_kernel()) {
     VLOG(1) << "XpuDeviceInterface initialized with SYCL kernel backend";
@@ -156,18 +268,15 @@ void XpuDeviceInterface::initializeVideo(
 
 void XpuDeviceInterface::registerHardwareDeviceWithCodec(
     AVCodecContext* codecContext) {
+  if (!surfaceSource_->usesHardwareDecoding()) {
+    // Emulated surfaces are fed from software decoder.
+    return;
+  }
   TORCH_CHECK(ctx_, "FFmpeg HW device has not been initialized");
   TORCH_CHECK(codecContext != nullptr, "codecContext is null");
   codecContext->hw_device_ctx = av_buffer_ref(ctx_.get());
 }
 
-VADisplay getVaDisplayFromAV(AVFrame* avFrame) {
-  AVHWFramesContext* hwfc = (AVHWFramesContext*)avFrame->hw_frames_ctx->data;
-  AVHWDeviceContext* hwdc = hwfc->device_ctx;
-  AVVAAPIDeviceContext* vactx = (AVVAAPIDeviceContext*)hwdc->hwctx;
-  return vactx->display;
-}
-
 struct xpuManagerCtx {
   UniqueAVFrame avFrame;
   ze_context_handle_t zeCtx = nullptr;
@@ -207,38 +316,12 @@ torch::Tensor AVFrameToTensor(
       desc.layers[0].num_planes);
 
   std::unique_ptr<xpuManagerCtx> context = std::make_unique<xpuManagerCtx>();
-  ze_device_handle_t ze_device{};
   sycl::queue queue = c10::xpu::getCurrentXPUStream(device.index());
+  LevelZeroHandles handles = getLevelZeroHandles(queue);
+  context->zeCtx = handles.context;
 
-  queue
-      .submit([&](sycl::handler& cgh) {
-        cgh.host_task([&](const sycl::interop_handle& ih) {
-          context->zeCtx =
-              ih.get_native_context<sycl::backend::ext_oneapi_level_zero>();
-          ze_device =
-              ih.get_native_device<sycl::backend::ext_oneapi_level_zero>();
-        });
-      })
-      .wait();
-
-  ze_external_memory_import_fd_t import_fd_desc{};
-  import_fd_desc.stype = ZE_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMPORT_FD;
-  import_fd_desc.flags = ZE_EXTERNAL_MEMORY_TYPE_FLAG_DMA_BUF;
-  import_fd_desc.fd = desc.objects[0].fd;
-
-  ze_device_mem_alloc_desc_t alloc_desc{};
-  alloc_desc.pNext = &import_fd_desc;
-  void* usm_ptr = nullptr;
-
-  ze_result_t res = zeMemAllocDevice(
-      context->zeCtx,
-      &alloc_desc,
-      desc.objects[0].size,
-      0,
-      ze_device,
-      &usm_ptr);
-  TORCH_CHECK(
-      res == ZE_RESULT_SUCCESS, "Failed to import fd=", desc.objects[0].fd);
+  void* usm_ptr =
+      importDmaBuf(handles, desc.objects[0].fd, desc.objects[0].size);
 
   close(desc.objects[0].fd);
 
@@ -289,13 +372,26 @@ void XpuDeviceInterface::convertAVFrameToFrameOutput(
     std::optional<torch::Tensor> preAllocatedOutputTensor) {
   // TODO: consider to copy handling of CPU frame from CUDA
   // TODO: consider to copy NV12 format check from CUDA
+  // Emulated surface source checks software frame formats on its own.
   TORCH_CHECK(
-      avFrame->format == AV_PIX_FMT_VAAPI,
+      !surfaceSource_->usesHardwareDecoding() ||
+          avFrame->format == AV_PIX_FMT_VAAPI,
       "Expected format to be AV_PIX_FMT_VAAPI, got " +
           std::string(av_get_pix_fmt_name((AVPixelFormat)avFrame->format)));
   auto frameDims = FrameDims(avFrame->height, avFrame->width);
+  // Batch decoding APIs pass pre-allocated output which TorchCodec
+  // allocates on the decoder device, so host output applies only to single
+  // frame APIs.
+  bool hostOutput = use_host_output() &&
+      surfaceSource_->usesHardwareDecoding() &&
+      !preAllocatedOutputTensor.has_value();
   torch::Tensor& dst = frameOutput.data;
   if (preAllocatedOutputTensor.has_value()) {
+    if (use_host_output()) {
+      TORCH_WARN_ONCE(
+          "USE_HOST_OUTPUT=1 applies only to single frame decoding APIs, "
+          "batch decoding APIs return frames in XPU tensors");
+    }
     auto shape = preAllocatedOutputTensor.value().sizes();
     TORCH_CHECK(
         (shape.size() == 3) && (shape[0] == frameDims.height) &&
@@ -307,18 +403,63 @@ void XpuDeviceInterface::convertAVFrameToFrameOutput(
         "x3, got ",
         shape);
     dst = preAllocatedOutputTensor.value();
+  } else if (hostOutput) {
+    // Pinned memory comes from PyTorch XPU caching host allocator, so
+    // buffers are reused across frames once consumers release them. Frame
+    // is converted into device memory and copied here in bulk transfers:
+    // scattered kernel writes over PCIe are much slower.
+    dst = torch::empty(
+        {frameDims.height, frameDims.width, 3},
+        torch::TensorOptions().dtype(torch::kUInt8).pinned_memory(true));
+  } else if (
+      use_shareable_output() && surfaceSource_->usesHardwareDecoding()) {
+    // Exportable allocation: frame can be exported to other processes
+    // without a copy. Memory of exported frames is never reused since
+    // importers might still hold it.
+    dst = allocateShareableTensor(
+        device_, {frameDims.height, frameDims.width, 3});
   } else {
-    dst = allocateEmptyHWCTensor(frameDims, device_);
+    dst = surfaceSource_->allocateOutput(frameDims);
+  }
+
+  std::optional<FrameStatistics> stats;
+  if (use_frame_statistics()) {
+    if (use_sycl_color_conversion_kernel()) {
+      stats = allocateFrameStatistics(*surfaceSource_);
+      stats->decoderId = decoderId_;
+      stats->ptsSeconds = frameOutput.ptsSeconds;
+    } else {
+      TORCH_WARN_ONCE(
+          "Frame statistics are collected only by SYCL kernel backend");
+    }
   }
 
   auto start = std::chrono::high_resolution_clock::now();
-  if (!convertAVFrameToFrameOutput_SYCL(avFrame, dst)) {
-    convertAVFrameToFrameOutput_FilterGraph(avFrame, dst);
+  bool convertedToHost =
+      hostOutput && !stats && convertAVFrameToHostOutput_SYCL(avFrame, dst);
+  if (!convertedToHost) {
+    // Statistics and filter graph backends need the whole frame converted
+    // before it can be copied to host.
+    torch::Tensor converted =
+        hostOutput ? surfaceSource_->allocateOutput(frameDims) : dst;
+    if (convertAVFrameToFrameOutput_SYCL(
+            avFrame, converted, stats ? &stats.value() : nullptr)) {
+      if (stats) {
+        recordFrameStatistics(std::move(stats.value()));
+      }
+    } else {
+      convertAVFrameToFrameOutput_FilterGraph(avFrame, converted);
+    }
+    if (hostOutput) {
+      dst.copy_(converted);
+    }
   }
 
   auto end = std::chrono::high_resolution_clock::now();
 
   std::chrono::duration<double, std::micro> duration = end - start;
+  // Includes surface mapping, see convertAVFrameToFrameOutput_SYCL() for
+  // the breakdown.
   VLOG(9) << "Conversion of frame height=" << frameDims.height << " width=" << frameDims.width
           << " took: " << duration.count() << "us" << std::endl;
 }
@@ -357,15 +498,10 @@ void XpuDeviceInterface::convertAVFrameToFrameOutput_FilterGraph(
 
   filtersContext.filtergraphStr = filters.str();
 
-  if (!filterGraphContext_ || prevFiltersContext_ != filtersContext) {
-    filterGraphContext_ =
-        std::make_unique<FilterGraph>(filtersContext, videoStreamOptions_);
-    prevFiltersContext_ = std::move(filtersContext);
-  }
-
   // We convert input to the RGBX color format with VAAPI getting WxHx4
   // tensor on the output.
-  UniqueAVFrame filteredAVFrame = filterGraphContext_->convert(avFrame);
+  UniqueAVFrame filteredAVFrame =
+      getFilterGraph(std::move(filtersContext)).convert(avFrame);
 
   TORCH_CHECK_EQ(filteredAVFrame->format, AV_PIX_FMT_VAAPI);
 
@@ -373,9 +509,42 @@ void XpuDeviceInterface::convertAVFrameToFrameOutput_FilterGraph(
   dst.copy_(dst_rgb4.narrow(2, 0, 3));
 }
 
+FilterGraph& XpuDeviceInterface::getFilterGraph(
+    FiltersContext&& filtersContext) {
+  for (auto it = filterGraphCache_.begin(); it != filterGraphCache_.end();
+       ++it) {
+    if (canReuseFilterGraph(it->filtersContext, filtersContext)) {
+      // Drop our reference to the frames context of the previous frames,
+      // filter graph keeps its own one until it is evicted.
+      it->filtersContext.hwFramesCtx = std::move(filtersContext.hwFramesCtx);
+      filterGraphCache_.splice(
+          filterGraphCache_.begin(), filterGraphCache_, it);
+      ++g_filter_graph_cache_hits;
+      return *filterGraphCache_.front().filterGraph;
+    }
+  }
+
+  int64_t rebuilds = ++g_filter_graph_cache_rebuilds;
+  VLOG(1) << "Building filter graph for " << filtersContext.inputWidth << "x"
+          << filtersContext.inputHeight << " frames, " << rebuilds
+          << " graphs built so far";
+
+  size_t cacheSize = filter_graph_cache_size();
+  while (filterGraphCache_.size() >= cacheSize) {
+    filterGraphCache_.pop_back();
+  }
+
+  auto filterGraph =
+      std::make_unique<FilterGraph>(filtersContext, videoStreamOptions_);
+  filterGraphCache_.push_front(
+      CachedFilterGraph{std::move(filtersContext), std::move(filterGraph)});
+  return *filterGraphCache_.front().filterGraph;
+}
+
 bool XpuDeviceInterface::convertAVFrameToFrameOutput_SYCL(
     [[maybe_unused]] UniqueAVFrame& frame,
-    [[maybe_unused]] torch::Tensor& dst) {
+    [[maybe_unused]] torch::Tensor& dst,
+    [[maybe_unused]] FrameStatistics* stats) {
   bool converted = false;
   if (!use_sycl_color_conversion_kernel()) {
     return converted;
@@ -383,66 +552,122 @@ bool XpuDeviceInterface::convertAVFrameToFrameOutput_SYCL(
 
 #ifdef WITH_SYCL_KERNELS
   VLOG(1) << "Using SYCL kernel backend for conversion";
-  TORCH_CHECK_EQ(frame->format, AV_PIX_FMT_VAAPI);
-  VADRMPRIMESurfaceDescriptor desc{};
-  VAStatus sts = vaExportSurfaceHandle(
-      getVaDisplayFromAV(frame.get()),
-      (VASurfaceID)(uintptr_t)frame->data[3],
-      VA_SURFACE_ATTRIB_MEM_TYPE_DRM_PRIME_2,
-      VA_EXPORT_SURFACE_READ_ONLY,
-      &desc);
-  TORCH_CHECK(
-      sts == VA_STATUS_SUCCESS,
-      "vaExportSurfaceHandle failed: ",
-      vaErrorStr(sts));
+  sycl::queue queue = surfaceSource_->getQueue();
+  auto mapStart = std::chrono::high_resolution_clock::now();
+  std::unique_ptr<TiledNV12Surface> surface = surfaceSource_->map(frame);
+  auto mapEnd = std::chrono::high_resolution_clock::now();
+
+  // Pre-allocated output might not be reachable from the queue. This
+  // happens with emulated surfaces on systems which do have XPU: batch APIs
+  // pre-allocate XPU tensors while the kernel runs on SYCL CPU device.
+  // Convert to scratch tensor then.
+  torch::Tensor rgb = isAccessibleFromQueue(queue, dst)
+      ? dst
+      : surfaceSource_->allocateOutput(FrameDims(frame->height, frame->width));
+
+  if (stats) {
+    FrameStatisticsBuffers buffers{
+        stats->lumaHistogram.data_ptr<int32_t>(),
+        stats->channelSums.data_ptr<int64_t>(),
+        stats->channelMean.data_ptr<float>(),
+        stats->channelVariance.data_ptr<float>(),
+        stats->thumbnail.data_ptr<uint8_t>(),
+        stats->thumbnailSums.data_ptr<int32_t>(),
+        THUMBNAIL_SIZE,
+        stats->perceptualHash.data_ptr<int64_t>()};
+    convertNV12ToRGBWithStatistics(
+        queue,
+        surface->yPlane,
+        surface->uvPlane,
+        rgb.data_ptr<uint8_t>(),
+        surface->width,
+        surface->height,
+        surface->pitch,
+        false,
+        buffers);
+  } else {
+    convertNV12ToRGB(
+        queue,
+        surface->yPlane,
+        surface->uvPlane,
+        rgb.data_ptr<uint8_t>(),
+        surface->width,
+        surface->height,
+        surface->pitch,
+        false);
+  }
+  auto kernelEnd = std::chrono::high_resolution_clock::now();
 
-  TORCH_CHECK(desc.num_objects == 1, "Expected 1 fd, got ", desc.num_objects);
-  std::unique_ptr<xpuManagerCtx> context = std::make_unique<xpuManagerCtx>();
-  ze_device_handle_t ze_device{};
-  sycl::queue queue = c10::xpu::getCurrentXPUStream(device_.index());
-  queue
-      .submit([&](sycl::handler& cgh) {
-        cgh.host_task([&](const sycl::interop_handle& ih) {
-          context->zeCtx =
-              ih.get_native_context<sycl::backend::ext_oneapi_level_zero>();
-          ze_device =
-              ih.get_native_device<sycl::backend::ext_oneapi_level_zero>();
-        });
-      })
-      .wait();
-
-  ze_external_memory_import_fd_t import_fd_desc{};
-  import_fd_desc.stype = ZE_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMPORT_FD;
-  import_fd_desc.flags = ZE_EXTERNAL_MEMORY_TYPE_FLAG_DMA_BUF;
-  import_fd_desc.fd = desc.objects[0].fd;
-
-  ze_device_mem_alloc_desc_t alloc_desc{};
-  alloc_desc.pNext = &import_fd_desc;
-  void* usm_ptr = nullptr;
-
-  ze_result_t res = zeMemAllocDevice(
-      context->zeCtx,
-      &alloc_desc,
-      desc.objects[0].size,
-      0,
-      ze_device,
-      &usm_ptr);
-  TORCH_CHECK(
-      res == ZE_RESULT_SUCCESS, "Failed to import fd=", desc.objects[0].fd);
+  std::chrono::duration<double, std::micro> mapDuration = mapEnd - mapStart;
+  std::chrono::duration<double, std::micro> kernelDuration =
+      kernelEnd - mapEnd;
+  VLOG(9) << "Mapping of surface took: " << mapDuration.count()
+          << "us, SYCL conversion took: " << kernelDuration.count() << "us";
 
-  close(desc.objects[0].fd);
+  if (!rgb.is_same(dst)) {
+    dst.copy_(rgb);
+  }
+  converted = true;
+#endif
+  return converted;
+}
+
+bool XpuDeviceInterface::convertAVFrameToHostOutput_SYCL(
+    [[maybe_unused]] UniqueAVFrame& frame,
+    [[maybe_unused]] torch::Tensor& dst) {
+  bool converted = false;
+  if (!use_sycl_color_conversion_kernel()) {
+    return converted;
+  }
 
-  convertNV12ToRGB(
-      queue,
-      (uint8_t*)usm_ptr + desc.layers[0].offset[0],
-      (uint8_t*)usm_ptr + desc.layers[1].offset[0],
-      (uint8_t*)dst.data_ptr(),
-      frame->width,
-      frame->height,
-      desc.layers[0].pitch[0],
-      false);
-
-  zeMemFree(context->zeCtx, usm_ptr);
+#ifdef WITH_SYCL_KERNELS
+  VLOG(1) << "Using SYCL kernel backend for conversion to host";
+  sycl::queue queue = surfaceSource_->getQueue();
+  sycl::queue& copyQueue = copyStream_->queue();
+  std::unique_ptr<TiledNV12Surface> surface = surfaceSource_->map(frame);
+
+  int width = surface->width;
+  int height = surface->height;
+  size_t rowBytes = (size_t)width * 3;
+  int bandRows = std::min(HOST_OUTPUT_BAND_ROWS, height);
+
+  // Band is converted into one half of the staging buffer while the other
+  // half is being copied to host.
+  torch::Tensor staging = surfaceSource_->allocateTensor(
+      {2, bandRows, width, 3}, torch::kUInt8);
+  uint8_t* stagingData = staging.data_ptr<uint8_t>();
+  uint8_t* hostData = dst.data_ptr<uint8_t>();
+
+  std::vector<sycl::event> copied(2);
+  for (int row = 0, band = 0; row < height; row += bandRows, ++band) {
+    int rows = std::min(bandRows, height - row);
+    int half = band % 2;
+    uint8_t* bandData = stagingData + half * bandRows * rowBytes;
+
+    std::vector<sycl::event> deps;
+    if (band >= 2) {
+      deps.push_back(copied[half]);
+    }
+    // Band starts at Y-tile row boundary of both planes, see
+    // HOST_OUTPUT_BAND_ROWS, so tiled planes of the band start at
+    // row * pitch and row / 2 * pitch bytes.
+    sycl::event bandConverted = submitNV12ToRGB(
+        queue,
+        surface->yPlane + (size_t)row * surface->pitch,
+        surface->uvPlane + (size_t)row / 2 * surface->pitch,
+        bandData,
+        width,
+        rows,
+        surface->pitch,
+        false,
+        deps);
+    copied[half] = copyQueue.submit([&](sycl::handler& cgh) {
+      cgh.depends_on(bandConverted);
+      cgh.memcpy(hostData + row * rowBytes, bandData, rows * rowBytes);
+    });
+  }
+  // Caller may read the frame right away.
+  sycl::event::wait(copied);
   converted = true;
 #endif
   return converted;
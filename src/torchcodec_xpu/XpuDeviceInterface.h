@@ -2,11 +2,26 @@
 
 #pragma once
 
+#include <list>
+#include <optional>
+
+#include <c10/xpu/XPUStream.h>
+
 #include "DeviceInterface.h"
 #include "FilterGraph.h"
+#include "FrameStatistics.h"
+#include "SurfaceSource.h"
 
 namespace facebook::torchcodec {
 
+// Process-wide counters of filter graph cache lookups.
+struct FilterGraphCacheStats {
+  int64_t hits = 0;
+  int64_t rebuilds = 0;
+};
+
+FilterGraphCacheStats getFilterGraphCacheStats();
+
 class XpuDeviceInterface : public DeviceInterface {
  public:
   XpuDeviceInterface(const torch::Device& device);
@@ -43,15 +58,39 @@ class XpuDeviceInterface : public DeviceInterface {
 
   UniqueAVBufferRef ctx_;
 
-  std::unique_ptr<FilterGraph> filterGraphContext_;
+  std::unique_ptr<SurfaceSource> surfaceSource_;
 
-  // Used to know whether a new FilterGraphContext should
-  // be created before decoding a new frame.
-  FiltersContext prevFiltersContext_;
+  // Stream copying host output to pinned memory while the next part of the
+  // frame is converted, see convertAVFrameToHostOutput_SYCL().
+  std::optional<c10::xpu::XPUStream> copyStream_;
+
+  // Recorded along with frame statistics.
+  int64_t decoderId_;
+
+  struct CachedFilterGraph {
+    FiltersContext filtersContext;
+    std::unique_ptr<FilterGraph> filterGraph;
+  };
+
+  // LRU cache of filter graphs, most recently used first. Streams which
+  // switch between few resolutions reuse graphs instead of rebuilding them.
+  // Graphs are matched ignoring identity of the frames context, see
+  // canReuseFilterGraph().
+  std::list<CachedFilterGraph> filterGraphCache_;
+
+  FilterGraph& getFilterGraph(FiltersContext&& filtersContext);
 
   // Optimized conversion. Return value indicates if conversion was
   // successfull.
+  // If stats is not null, per-frame statistics are collected in the same pass.
   bool convertAVFrameToFrameOutput_SYCL(
+      UniqueAVFrame& avFrame,
+      torch::Tensor& dst,
+      FrameStatistics* stats);
+  // Converts frame in bands of rows which are copied into pinned host
+  // memory dst on copyStream_ while the next band is converted. Return
+  // value indicates if conversion was successfull.
+  bool convertAVFrameToHostOutput_SYCL(
       UniqueAVFrame& avFrame,
       torch::Tensor& dst);
   // Fallback conversion if optimized path is not available.
@@ -0,0 +1,107 @@
+// Copyright (c) 2025 Dmitry Rogozhkin.
+
+#include <torch/library.h>
+
+#include "FrameSharing.h"
+#include "FrameStatistics.h"
+#include "XpuDeviceInterface.h"
+
+namespace facebook::torchcodec {
+
+namespace {
+
+std::tuple<
+    torch::Tensor,
+    torch::Tensor,
+    torch::Tensor,
+    torch::Tensor,
+    torch::Tensor,
+    torch::Tensor,
+    torch::Tensor>
+pop_frame_statistics() {
+  std::vector<FrameStatistics> stats = takeFrameStatistics();
+  if (stats.empty()) {
+    return std::make_tuple(
+        torch::empty({0}, torch::kInt64),
+        torch::empty({0}, torch::kFloat64),
+        torch::empty({0, LUMA_HISTOGRAM_BINS}, torch::kInt32),
+        torch::empty({0, 3}, torch::kFloat32),
+        torch::empty({0, 3}, torch::kFloat32),
+        torch::empty({0, THUMBNAIL_SIZE, THUMBNAIL_SIZE, 3}, torch::kUInt8),
+        torch::empty({0}, torch::kInt64));
+  }
+
+  std::vector<int64_t> decoderIds;
+  std::vector<double> pts;
+  std::vector<torch::Tensor> histograms;
+  std::vector<torch::Tensor> means;
+  std::vector<torch::Tensor> variances;
+  std::vector<torch::Tensor> thumbnails;
+  std::vector<torch::Tensor> hashes;
+  for (const auto& s : stats) {
+    decoderIds.push_back(s.decoderId);
+    pts.push_back(s.ptsSeconds);
+    histograms.push_back(s.lumaHistogram);
+    means.push_back(s.channelMean);
+    variances.push_back(s.channelVariance);
+    thumbnails.push_back(s.thumbnail);
+    hashes.push_back(s.perceptualHash);
+  }
+  return std::make_tuple(
+      torch::tensor(decoderIds, torch::kInt64),
+      torch::tensor(pts, torch::kFloat64),
+      torch::stack(histograms),
+      torch::stack(means),
+      torch::stack(variances),
+      torch::stack(thumbnails),
+      torch::stack(hashes));
+}
+
+int64_t get_last_decoder_id() {
+  return getLastDecoderId();
+}
+
+std::tuple<int64_t, int64_t, int64_t, std::vector<int64_t>> export_frame(
+    const torch::Tensor& frame) {
+  ExportedFrame exported = exportFrame(frame);
+  return std::make_tuple(
+      (int64_t)exported.fd, exported.size, exported.offset, exported.strides);
+}
+
+torch::Tensor import_frame(
+    int64_t fd,
+    int64_t size,
+    int64_t offset,
+    at::IntArrayRef shape,
+    at::IntArrayRef strides,
+    at::Device device) {
+  ExportedFrame exported;
+  exported.fd = (int)fd;
+  exported.size = size;
+  exported.offset = offset;
+  exported.strides = strides.vec();
+  return importFrame(device, exported, shape);
+}
+
+std::tuple<int64_t, int64_t> get_filter_graph_cache_stats() {
+  FilterGraphCacheStats stats = getFilterGraphCacheStats();
+  return std::make_tuple(stats.hits, stats.rebuilds);
+}
+
+} // namespace
+
+TORCH_LIBRARY(torchcodec_xpu, m) {
+  m.def(
+      "pop_frame_statistics() -> (Tensor, Tensor, Tensor, Tensor, Tensor, Tensor, Tensor)",
+      &pop_frame_statistics);
+  m.def("get_last_decoder_id() -> int", &get_last_decoder_id);
+  m.def("export_frame(Tensor frame) -> (int, int, int, int[])", &export_frame);
+  m.def(
+      "import_frame(int fd, int size, int offset, int[] shape, int[] strides, Device device) -> Tensor",
+      &import_frame);
+  m.def(
+      "get_filter_graph_cache_stats() -> (int, int)",
+      &get_filter_graph_cache_stats);
+}
+
+} // namespace facebook::torchcodec
@@ -3,6 +3,8 @@
 
 import ctypes
 import importlib
+import multiprocessing.reduction
+import os
 import traceback
 
 import torch
@@ -48,3 +50,114 @@ def load_torchcodec_xpu_shared_library():
 
 load_torchcodec_xpu_shared_library()
 
+
+def pop_frame_statistics():
+    """Returns statistics of frames converted on the calling thread.
+
+    Statistics are collected by SYCL color conversion kernel when
+    ``USE_FRAME_STATISTICS=1`` is set. Each call returns statistics recorded
+    since the previous call as a dict of tensors stacked along the first
+    dimension. Use ``decoder_id`` and ``pts_seconds`` to match entries with
+    decoded frames when several decoders run on the same thread, see
+    :func:`last_decoder_id`.
+    """
+    (
+        decoder_id,
+        pts_seconds,
+        luma_histogram,
+        channel_mean,
+        channel_variance,
+        thumbnail,
+        perceptual_hash,
+    ) = torch.ops.torchcodec_xpu.pop_frame_statistics()
+    return {
+        "decoder_id": decoder_id,
+        "pts_seconds": pts_seconds,
+        "luma_histogram": luma_histogram,
+        "channel_mean": channel_mean,
+        "channel_variance": channel_variance,
+        "thumbnail": thumbnail,
+        "perceptual_hash": perceptual_hash,
+    }
+
+
+def last_decoder_id():
+    """Returns id of the XPU decoder most recently created on the calling thread.
+
+    Ids are recorded as ``decoder_id`` by :func:`pop_frame_statistics`.
+    """
+    return torch.ops.torchcodec_xpu.get_last_decoder_id()
+
+
+class SharedFrame:
+    """Handle to XPU frame which can be sent to another process.
+
+    Frame memory is shared as dma-buf file descriptor, so the receiving
+    process gets the same device memory without copies. Pickling the handle
+    with multiprocessing (for example, returning it from a DataLoader worker)
+    transfers the descriptor. Memory stays alive while there are open handles
+    or imported tensors, so sender may drop the frame right away.
+    """
+
+    def __init__(self, fd, size, offset, shape, strides):
+        self._fd = fd
+        self._size = size
+        self._offset = offset
+        self._shape = tuple(shape)
+        self._strides = tuple(strides)
+
+    def __del__(self):
+        if getattr(self, "_fd", -1) >= 0:
+            os.close(self._fd)
+            self._fd = -1
+
+    def __reduce__(self):
+        return (
+            _rebuild_shared_frame,
+            (
+                multiprocessing.reduction.DupFd(self._fd),
+                self._size,
+                self._offset,
+                self._shape,
+                self._strides,
+            ),
+        )
+
+    def to_tensor(self, device="xpu"):
+        """Imports the frame as XPU tensor without a copy."""
+        return torch.ops.torchcodec_xpu.import_frame(
+            self._fd,
+            self._size,
+            self._offset,
+            list(self._shape),
+            list(self._strides),
+            torch.device(device),
+        )
+
+
+def _rebuild_shared_frame(dup_fd, size, offset, shape, strides):
+    return SharedFrame(dup_fd.detach(), size, offset, shape, strides)
+
+
+def share_frame(frame):
+    """Exports XPU uint8 frame for sharing with other processes.
+
+    Frames decoded with ``USE_SHAREABLE_OUTPUT=1`` and their views (such as
+    frames in the default NCHW dimension order) are exported without a copy
+    and imported with the same strides. Other frames, including frames
+    returned by batch decoding APIs, are first copied into shareable device
+    memory.
+    """
+    fd, size, offset, strides = torch.ops.torchcodec_xpu.export_frame(frame)
+    return SharedFrame(fd, size, offset, frame.shape, strides)
+
+
+def filter_graph_cache_stats():
+    """Returns process-wide counters of VAAPI filter graph cache lookups.
+
+    ``hits`` counts frames converted with a cached filter graph and
+    ``rebuilds`` counts filter graphs built. Size of the per-decoder cache
+    is set with ``FILTER_GRAPH_CACHE_SIZE`` (4 by default).
+    """
+    hits, rebuilds = torch.ops.torchcodec_xpu.get_filter_graph_cache_stats()
+    return {"hits": hits, "rebuilds": rebuilds}
@@ -0,0 +1,65 @@
+# Copyright (c) 2025 Dmitry Rogozhkin.
+
+from utils import make_video, needs_ffmpeg_cli, run_with_env
+
+EMULATED = {"USE_EMULATED_SURFACES": "1"}
+
+
+@needs_ffmpeg_cli
+def test_emulated_single_frame_apis(tmp_path):
+    video = make_video(str(tmp_path / "video.ts"), [(320, 240, 10)])
+    out = run_with_env(
+        f"""
+        import json
+        import torch
+        import torchcodec_xpu
+        from torchcodec.decoders import VideoDecoder
+
+        path = {video!r}
+        emulated = VideoDecoder(path, device="xpu", dimension_order="NHWC")
+        reference = VideoDecoder(path, dimension_order="NHWC")
+        results = []
+        for i in [0, 3, 9]:
+            frame = emulated[i]
+            ref = reference[i]
+            diff = (frame.int() - ref.int()).abs().float().mean().item()
+            results.append(
+                {{"device": frame.device.type, "shape": list(frame.shape), "diff": diff}}
+            )
+        frame = emulated.get_frame_at(5)
+        results.append(
+            {{"device": frame.data.device.type, "shape": list(frame.data.shape),
+              "diff": (frame.data.int() - reference[5].int()).abs().float().mean().item()}}
+        )
+        print(json.dumps(results))
+        """,
+        EMULATED,
+    )
+    for result in out:
+        assert result["device"] == "cpu"
+        assert result["shape"] == [240, 320, 3]
+        # Chroma upsampling and rounding differ from swscale.
+        assert result["diff"] < 3
+
+
+@needs_ffmpeg_cli
+def test_emulated_unaligned_dimensions(tmp_path):
+    # Frame is smaller than a single Y-tile and its width is not a multiple
+    # of the tile width.
+    video = make_video(str(tmp_path / "video.ts"), [(34, 18, 2)])
+    out = run_with_env(
+        f"""
+        import json
+        import torchcodec_xpu
+        from torchcodec.decoders import VideoDecoder
+
+        path = {video!r}
+        frame = VideoDecoder(path, device="xpu", dimension_order="NHWC")[1]
+        ref = VideoDecoder(path, dimension_order="NHWC")[1]
+        diff = (frame.int() - ref.int()).abs().float().mean().item()
+        print(json.dumps({{"shape": list(frame.shape), "diff": diff}}))
+        """,
+        EMULATED,
+    )
+    assert out["shape"] == [18, 34, 3]
+    assert out["diff"] < 6
@@ -0,0 +1,31 @@
+# Copyright (c) 2025 Dmitry Rogozhkin.
+
+from utils import make_video, needs_ffmpeg_cli, needs_xpu, run_with_env
+
+
+@needs_xpu
+@needs_ffmpeg_cli
+def test_filter_graph_cache_resolution_switch(tmp_path):
+    # Decoder allocates new surface pool on each resolution change, graph
+    # built for the first segment must still be reused for the last one.
+    segments = [(320, 240, 5), (640, 480, 5), (320, 240, 5)]
+    video = make_video(str(tmp_path / "video.ts"), segments)
+    out = run_with_env(
+        f"""
+        import json
+        import torchcodec_xpu
+        from torchcodec.decoders import VideoDecoder
+
+        decoder = VideoDecoder({video!r}, device="xpu", dimension_order="NHWC")
+        shapes = [list(decoder[i].shape) for i in range(15)]
+        print(json.dumps({{
+            "shapes": shapes,
+            "stats": torchcodec_xpu.filter_graph_cache_stats(),
+        }}))
+        """,
+        {"USE_SYCL_KERNELS": "0"},
+    )
+    expected = [[h, w, 3] for w, h, n in segments for _ in range(n)]
+    assert out["shapes"] == expected
+    assert out["stats"]["hits"] > 0
+    assert out["stats"]["rebuilds"] == 2
@@ -0,0 +1,86 @@
+# Copyright (c) 2025 Dmitry Rogozhkin.
+
+from utils import make_video, needs_ffmpeg_cli, needs_xpu, run_with_env
+
+# Dataset has to be importable by spawned DataLoader workers.
+DATASET = """
+import torch
+import torchcodec_xpu
+from torchcodec.decoders import VideoDecoder
+
+
+class SharedFrames(torch.utils.data.Dataset):
+    def __init__(self, path, num_frames):
+        self.path = path
+        self.num_frames = num_frames
+        self.decoder = None
+
+    def __len__(self):
+        return self.num_frames
+
+    def __getitem__(self, i):
+        if self.decoder is None:
+            self.decoder = VideoDecoder(self.path, device="xpu")
+        return torchcodec_xpu.share_frame(self.decoder[i])
+"""
+
+
+@needs_xpu
+@needs_ffmpeg_cli
+def test_share_frames_from_dataloader_worker(tmp_path):
+    video = make_video(str(tmp_path / "video.ts"), [(320, 240, 4)])
+    (tmp_path / "shared_frames.py").write_text(DATASET)
+    out = run_with_env(
+        f"""
+        import json
+        import sys
+        import torch
+        import torchcodec_xpu
+        from torchcodec.decoders import VideoDecoder
+
+        sys.path.insert(0, {str(tmp_path)!r})
+        from shared_frames import SharedFrames
+
+        path = {video!r}
+        loader = torch.utils.data.DataLoader(
+            SharedFrames(path, 4),
+            batch_size=None,
+            num_workers=1,
+            multiprocessing_context="spawn",
+        )
+        frames = [shared.to_tensor() for shared in loader]
+        # Imported frames stay valid after the worker exits.
+        del loader
+
+        reference = VideoDecoder(path, device="xpu")
+        print(json.dumps({{
+            "equal": [torch.equal(f, reference[i]) for i, f in enumerate(frames)],
+            "strides": [list(f.stride()) for f in frames],
+            "reference_strides": list(reference[0].stride()),
+        }}))
+        """,
+        {"USE_SHAREABLE_OUTPUT": "1"},
+    )
+    assert out["equal"] == [True] * 4
+    # Default NCHW frames are permuted views and are imported as such.
+    assert out["strides"] == [out["reference_strides"]] * 4
+
+
+@needs_xpu
+@needs_ffmpeg_cli
+def test_share_batch_frame(tmp_path):
+    video = make_video(str(tmp_path / "video.ts"), [(320, 240, 4)])
+    out = run_with_env(
+        f"""
+        import json
+        import torch
+        import torchcodec_xpu
+        from torchcodec.decoders import VideoDecoder
+
+        batch = VideoDecoder({video!r}, device="xpu").get_frames_at([0, 2]).data
+        copied = torchcodec_xpu.share_frame(batch[1]).to_tensor()
+        print(json.dumps({{"equal": torch.equal(batch[1], copied)}}))
+        """,
+        {"USE_SHAREABLE_OUTPUT": "1"},
+    )
+    assert out["equal"]
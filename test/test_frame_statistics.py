@@ -0,0 +1,133 @@
+# Copyright (c) 2025 Dmitry Rogozhkin.
+
+import pytest
+import torch
+from utils import decode_yuv420p, make_video, needs_ffmpeg_cli, run_with_env
+
+# Statistics are checked against CPU reference computed from converted
+# frames, so emulated surfaces let the test run without a GPU.
+ENV = {"USE_EMULATED_SURFACES": "1", "USE_FRAME_STATISTICS": "1"}
+
+THUMBNAIL_SIZE = 32
+HASH_SIZE = 8
+
+
+def reference_statistics(frame, luma):
+    """Computes statistics the same way as the SYCL kernel."""
+    height, width, _ = frame.shape
+    pixels = frame.reshape(-1, 3).double()
+    mean = pixels.mean(0)
+    var = (pixels * pixels).mean(0) - mean * mean
+
+    def cells(length):
+        for i in range(THUMBNAIL_SIZE):
+            begin = i * length // THUMBNAIL_SIZE
+            yield begin, max((i + 1) * length // THUMBNAIL_SIZE, begin + 1)
+
+    # Each thumbnail pixel is rounded average of the frame area it covers.
+    thumbnail = torch.empty(THUMBNAIL_SIZE, THUMBNAIL_SIZE, 3, dtype=torch.uint8)
+    for ty, (y0, y1) in enumerate(cells(height)):
+        for tx, (x0, x1) in enumerate(cells(width)):
+            area = frame[y0:y1, x0:x1].reshape(-1, 3).long()
+            n = area.shape[0]
+            thumbnail[ty, tx] = (area.sum(0) + n // 2) // n
+    t = thumbnail.int()
+    cell_luma = (54 * t[..., 0] + 183 * t[..., 1] + 19 * t[..., 2]) >> 8
+    block = THUMBNAIL_SIZE // HASH_SIZE
+    cells = cell_luma.view(HASH_SIZE, block, HASH_SIZE, block).sum((1, 3)).flatten()
+    total = cells.sum()
+    hash = 0
+    for i, cell in enumerate(cells.tolist()):
+        if cell * HASH_SIZE * HASH_SIZE > total:
+            hash |= 1 << i
+    # Stored as int64.
+    if hash >= 1 << 63:
+        hash -= 1 << 64
+
+    return {
+        "histogram": torch.bincount(luma.flatten().long(), minlength=256),
+        "mean": mean,
+        "var": var,
+        "thumbnail": thumbnail,
+        "hash": hash,
+    }
+
+
+@needs_ffmpeg_cli
+@pytest.mark.parametrize(
+    "width, height",
+    [
+        (320, 240),
+        # Thumbnail cells of different widths.
+        (40, 48),
+        # Narrower and lower than the thumbnail: pixels belong to
+        # several thumbnail cells.
+        (24, 18),
+    ],
+)
+def test_frame_statistics(tmp_path, width, height):
+    video = make_video(str(tmp_path / "video.ts"), [(width, height, 3)])
+    out_path = tmp_path / "out.pt"
+    out = run_with_env(
+        f"""
+        import json
+        import torch
+        import torchcodec_xpu
+        from torchcodec.decoders import VideoDecoder
+
+        decoder = VideoDecoder({video!r}, device="xpu", dimension_order="NHWC")
+        decoder_id = torchcodec_xpu.last_decoder_id()
+        frames = [decoder[i] for i in range(3)]
+        stats = torchcodec_xpu.pop_frame_statistics()
+        torch.save({{"frames": frames, "stats": stats}}, {str(out_path)!r})
+        print(json.dumps({{"decoder_id": decoder_id}}))
+        """,
+        ENV,
+    )
+    saved = torch.load(out_path)
+    stats = saved["stats"]
+    lumas = decode_yuv420p(video, width, height)
+
+    assert stats["decoder_id"].tolist() == [out["decoder_id"]] * 3
+    for i, frame in enumerate(saved["frames"]):
+        ref = reference_statistics(frame, lumas[i])
+        assert torch.equal(stats["luma_histogram"][i].long(), ref["histogram"])
+        torch.testing.assert_close(
+            stats["channel_mean"][i].double(), ref["mean"], rtol=1e-4, atol=1e-3
+        )
+        torch.testing.assert_close(
+            stats["channel_variance"][i].double(), ref["var"], rtol=1e-3, atol=1e-1
+        )
+        assert torch.equal(stats["thumbnail"][i], ref["thumbnail"])
+        assert stats["perceptual_hash"][i].item() == ref["hash"]
+
+
+@needs_ffmpeg_cli
+def test_frame_statistics_per_decoder(tmp_path):
+    video = make_video(str(tmp_path / "video.ts"), [(64, 48, 4)])
+    out = run_with_env(
+        f"""
+        import json
+        import torchcodec_xpu
+        from torchcodec.decoders import VideoDecoder
+
+        first = VideoDecoder({video!r}, device="xpu")
+        first_id = torchcodec_xpu.last_decoder_id()
+        second = VideoDecoder({video!r}, device="xpu")
+        second_id = torchcodec_xpu.last_decoder_id()
+        first[0]
+        second[1]
+        first[2]
+        stats = torchcodec_xpu.pop_frame_statistics()
+        print(json.dumps({{
+            "ids": [first_id, second_id],
+            "decoder_id": stats["decoder_id"].tolist(),
+            "again": len(torchcodec_xpu.pop_frame_statistics()["decoder_id"]),
+        }}))
+        """,
+        ENV,
+    )
+    first_id, second_id = out["ids"]
+    assert first_id != second_id
+    assert out["decoder_id"] == [first_id, second_id, first_id]
+    assert out["again"] == 0
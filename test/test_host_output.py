@@ -0,0 +1,50 @@
+# Copyright (c) 2025 Dmitry Rogozhkin.
+
+import pytest
+import torch
+from utils import make_video, needs_ffmpeg_cli, needs_xpu, run_with_env
+
+DECODE = """
+import json
+import torch
+import torchcodec_xpu
+from torchcodec.decoders import VideoDecoder
+
+decoder = VideoDecoder({video!r}, device="xpu", dimension_order="NHWC")
+frames = [decoder[i] for i in range(3)]
+batch = decoder.get_frames_at([0, 2]).data
+torch.save({{"frames": frames, "batch": batch.cpu()}}, {out!r})
+print(json.dumps({{
+    "devices": [f.device.type for f in frames],
+    "pinned": [f.is_pinned() for f in frames],
+    "batch_device": batch.device.type,
+}}))
+"""
+
+
+@needs_xpu
+@needs_ffmpeg_cli
+@pytest.mark.parametrize("env", [{}, {"USE_FRAME_STATISTICS": "1"}])
+def test_host_output(tmp_path, env):
+    # Frame is higher than a band of rows converted at once and its height
+    # is not a multiple of the band height.
+    video = make_video(str(tmp_path / "video.ts"), [(640, 600, 3)])
+    host_path = str(tmp_path / "host.pt")
+    ref_path = str(tmp_path / "ref.pt")
+
+    out = run_with_env(
+        DECODE.format(video=video, out=host_path), {"USE_HOST_OUTPUT": "1", **env}
+    )
+    assert out["devices"] == ["cpu"] * 3
+    assert all(out["pinned"])
+    assert out["batch_device"] == "xpu"
+
+    ref = run_with_env(DECODE.format(video=video, out=ref_path), env)
+    assert ref["devices"] == ["xpu"] * 3
+
+    host = torch.load(host_path)
+    expected = torch.load(ref_path, map_location="cpu")
+    for frame, ref_frame in zip(host["frames"], expected["frames"]):
+        assert frame.shape == (600, 640, 3)
+        assert torch.equal(frame, ref_frame)
+    assert torch.equal(host["batch"], expected["batch"])
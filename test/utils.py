@@ -0,0 +1,89 @@
+# Copyright (c) 2025 Dmitry Rogozhkin.
+
+import json
+import os
+import shutil
+import subprocess
+import sys
+import textwrap
+
+import pytest
+import torch
+
+
+def _xpu_available():
+    return hasattr(torch, "xpu") and torch.xpu.is_available()
+
+
+# Plugin reads its settings from environment variables at load time, so
+# tests which need specific settings run their code in a subprocess.
+needs_xpu = pytest.mark.skipif(not _xpu_available(), reason="XPU not available.")
+needs_ffmpeg_cli = pytest.mark.skipif(
+    shutil.which("ffmpeg") is None, reason="ffmpeg CLI not available."
+)
+
+
+def make_video(path, segments, fps=30):
+    """Encodes H.264 video out of testsrc segments of (width, height, frames).
+
+    Segments are encoded as MPEG-TS and concatenated, so that resolution
+    changes mid-stream the same way as with adaptive bitrate sources.
+    """
+    with open(path, "wb") as out:
+        for i, (width, height, frames) in enumerate(segments):
+            segment = f"{path}.{i}.ts"
+            subprocess.run(
+                [
+                    "ffmpeg", "-y", "-loglevel", "error",
+                    "-f", "lavfi",
+                    "-i", f"testsrc2=size={width}x{height}:rate={fps}",
+                    "-frames:v", str(frames),
+                    "-c:v", "libx264", "-pix_fmt", "yuv420p",
+                    "-colorspace", "bt709", "-color_primaries", "bt709",
+                    "-color_trc", "bt709", "-color_range", "tv",
+                    segment,
+                ],
+                check=True,
+            )
+            with open(segment, "rb") as f:
+                out.write(f.read())
+            os.remove(segment)
+    return path
+
+
+def decode_yuv420p(path, width, height):
+    """Returns luma planes of all frames decoded by ffmpeg CLI."""
+    raw = subprocess.run(
+        [
+            "ffmpeg", "-loglevel", "error", "-i", path,
+            "-f", "rawvideo", "-pix_fmt", "yuv420p", "-",
+        ],
+        check=True,
+        capture_output=True,
+    ).stdout
+    frame = torch.frombuffer(bytearray(raw), dtype=torch.uint8)
+    luma = width * height
+    chroma = ((width + 1) // 2) * ((height + 1) // 2)
+    frame = frame.view(-1, luma + 2 * chroma)
+    return frame[:, :luma].reshape(-1, height, width)
+
+
+def run_with_env(code, env):
+    """Runs code in a fresh interpreter with extra environment variables.
+
+    Code should print a single JSON document as its last line of output.
+    """
+    result = subprocess.run(
+        [sys.executable, "-c", textwrap.dedent(code)],
+        env={**os.environ, **env},
+        capture_output=True,
+        text=True,
+    )
+    if result.returncode != 0:
+        if (
+            "Emulated surfaces require SYCL" in result.stderr
+            and os.environ.get("FAIL_WITHOUT_SYCL") is None
+        ):
+            pytest.skip("Plugin is built without SYCL kernels.")
+        raise AssertionError(result.stderr)
+    return json.loads(result.stdout.strip().splitlines()[-1])